@@ -170,6 +170,16 @@ void readPara(OptimiserPara &dst,
 
     dst.saveRefEachIter = JSONCPP_READ_ERROR_HANDLER(src["Advanced"][KEY_SAVE_REF_EACH_ITER], KEY_SAVE_REF_EACH_ITER).asBool();
     dst.saveTHUEachIter = JSONCPP_READ_ERROR_HANDLER(src["Advanced"][KEY_SAVE_THU_EACH_ITER], KEY_SAVE_THU_EACH_ITER).asBool();
+
+    // optional, parameter files without it never save checkpoints
+    if (src["Advanced"].isMember(KEY_CHECKPOINT_EACH))
+        dst.checkpointEach = src["Advanced"][KEY_CHECKPOINT_EACH].asInt();
+
+    // optional, parameter files without them never profile
+    if (src["Advanced"].isMember(KEY_PROFILE))
+        dst.profile = src["Advanced"][KEY_PROFILE].asBool();
+    if (src["Advanced"].isMember(KEY_PROFILE_TRACE))
+        dst.profileTrace = src["Advanced"][KEY_PROFILE_TRACE].asBool();
     dst.mLT = JSONCPP_READ_ERROR_HANDLER(src["Advanced"][KEY_M_L_T], KEY_M_L_T).asInt();
     dst.mLD = JSONCPP_READ_ERROR_HANDLER(src["Advanced"][KEY_M_L_D], KEY_M_L_D).asInt();
     dst.mReco = JSONCPP_READ_ERROR_HANDLER(src["Advanced"][KEY_M_RECO], KEY_M_RECO).asInt();
@@ -332,7 +342,8 @@ int main(int argc, char *argv[])
         return 0;
     }
 
-    else if (argc != 2)
+    else if ((argc != 2) &&
+             !((argc == 3) && (strcmp(argv[2], "--resume") == 0)))
     {
         cout << "Wrong Number of Parameters Input!"
              << endl;
@@ -349,6 +360,8 @@ int main(int argc, char *argv[])
     genLogFileFullNameAndSetDstPrefix(logFileFullName, jsonReader, jsonRoot, thunderPara, argv[1]);
     loggerInit(logFileFullName);
 
+    thunderPara.resume = (argc == 3);
+
 
     //ifstream jsonFile(argv[1], ios::binary);
 
@@ -552,6 +565,28 @@ int main(int argc, char *argv[])
 
     TSFFTW_set_timelimit(60);
 
+#ifdef FFT_PLAN_CACHE
+    char wisdomName[FILE_NAME_LENGTH];
+
+    // a truncated name would point to the wisdom of another run, thus skip it
+
+    bool wisdom = (snprintf(wisdomName,
+                            sizeof(wisdomName),
+                            "%s%s",
+                            thunderPara.dstPrefix,
+                            FFT_WISDOM_FILE) < (int)sizeof(wisdomName));
+
+    if (!wisdom && (rank == 0))
+    {
+        CLOG(WARNING, "LOGGER_SYS") << "Too Long Path of FFTW Wisdom, Skipping Importing and Exporting It";
+    }
+
+    if (wisdom && FFT::importWisdom(wisdomName) && (rank == 0))
+    {
+        CLOG(INFO, "LOGGER_SYS") << "FFTW Wisdom Imported from " << wisdomName;
+    }
+#endif
+
     if (rank == 0)
     {
         CLOG(INFO, "LOGGER_SYS") << "Setting Parameters";
@@ -573,6 +608,18 @@ int main(int argc, char *argv[])
     }
 
     opt.run();
+
+#ifdef FFT_PLAN_CACHE
+    // the first process carrying out expectation holds the most wisdom
+    if (wisdom && (rank == ((size > 1) ? HEMI_A_LEAD : 0)))
+    {
+        if (!FFT::exportWisdom(wisdomName))
+        {
+            CLOG(WARNING, "LOGGER_SYS") << "Fail to Export FFTW Wisdom to " << wisdomName;
+        }
+    }
+#endif
+
     MPI_Finalize();
     TSFFTW_cleanup_threads();
     return 0;
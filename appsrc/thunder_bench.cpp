@@ -0,0 +1,716 @@
+/** @file
+ *  @copyright THUNDER Non-Commercial Software License Agreement
+ *
+ *  @brief thunder_bench.cpp times the hot kernels of THUNDER on reproducible synthetic inputs across box sizes and numbers of threads. The results are written in JSON as nanoseconds, bytes and floating point operations per operation, and are compared with a baseline written by thunder_bench before to flag regressions.
+ *
+ */
+
+#include <unistd.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+#include <json/json.h>
+
+#include "Config.h"
+#include "Logging.h"
+#include "Macro.h"
+#include "Projector.h"
+#include "Reconstructor.h"
+#include "FFT.h"
+#include "CTF.h"
+#include "Spectrum.h"
+#include "Transformation.h"
+#include "Profiler.h"
+#include "Optimiser.h"
+
+INITIALIZE_EASYLOGGINGPP
+
+#define PROGRAM_NAME "thunder_bench"
+
+/**
+ * the seed of the synthetic inputs, thus every run times the same data
+ */
+#define BENCH_SEED 20150323
+
+/**
+ * the number of images compared with a projection in logDataVSPrior_m_n
+ */
+#define BENCH_N_IMAGE 256
+
+/**
+ * the number of images inserted before reconstruction
+ */
+#define BENCH_N_INSERT 64
+
+/**
+ * kernels timed by a single thread are called this many times per thread in a
+ * parallel loop, and the time is divided among the calls
+ */
+#define BENCH_BATCH_PER_THREAD 8
+
+/**
+ * the floating point operations of comparing a pixel in logDataVSPrior
+ */
+#define BENCH_FLOP_DATA_VS_PRIOR 9
+
+#define emit_try_help() \
+do \
+    { \
+        fprintf(stderr, "Try '%s --help' for more information.\n", \
+                PROGRAM_NAME); \
+    } \
+while(0)
+
+#define HELP_OPTION_DESCRIPTION "--help     display this help\n"
+
+void usage(int status)
+{
+    if (status != EXIT_SUCCESS)
+    {
+        emit_try_help ();
+    }
+    else
+    {
+        printf("Usage: %s [OPTION]...\n", PROGRAM_NAME);
+
+        fputs("Time the hot kernels of THUNDER on synthetic inputs, and write the results in JSON.\n", stdout);
+
+        fputs("-o    set the directory of output file, standard output by default.\n", stdout);
+        fputs("--size    set the box sizes, separated by comma, 64,128 by default.\n", stdout);
+        fputs("-j    set the numbers of threads, separated by comma, 1 and all threads by default.\n", stdout);
+        fputs("--kernel    only time the kernels whose names contain this string.\n", stdout);
+        fputs("--time    set the minimum seconds of timing each kernel, 0.2 by default.\n", stdout);
+        fputs("--baseline    set the directory of the results to be compared with.\n", stdout);
+        fputs("--tolerance    set the relative slow-down regarded as regression, 0.1 by default.\n", stdout);
+
+        fputs(HELP_OPTION_DESCRIPTION, stdout);
+
+        fputs("Note: the exit status is 1 if any regression is found.\n", stdout);
+    }
+    exit(status);
+}
+
+static const struct option long_options[] =
+{
+    {"size", required_argument, NULL, 's'},
+    {"kernel", required_argument, NULL, 'k'},
+    {"time", required_argument, NULL, 't'},
+    {"baseline", required_argument, NULL, 'b'},
+    {"tolerance", required_argument, NULL, 'r'},
+    {"help", no_argument, NULL, 'h'},
+    {NULL, 0, NULL, 0}
+};
+
+struct BenchResult
+{
+    std::string kernel;
+
+    int size;
+
+    int nThread;
+
+    double ns;
+
+    /**
+     * bytes moved and floating point operations per operation, 0 if not
+     * modelled
+     */
+    double bytes;
+
+    double flops;
+};
+
+struct BenchPara
+{
+    std::string kernel;
+
+    double minTime;
+};
+
+static std::vector<int> parseList(const char* src)
+{
+    std::vector<int> dst;
+
+    std::stringstream ss(src);
+    std::string item;
+
+    while (std::getline(ss, item, ','))
+        if (atoi(item.c_str()) > 0) dst.push_back(atoi(item.c_str()));
+
+    if (dst.empty()) usage(EXIT_FAILURE);
+
+    return dst;
+}
+
+/**
+ * the seconds of an operation, which is repeated until it lasts the minimum
+ * time, and the fastest of three repetitions is taken
+ */
+template <typename F>
+static double timeOp(F op,
+                     const double minTime)
+{
+    op();
+
+    long n = 1;
+
+    double t;
+
+    while (true)
+    {
+        double start = Profiler::time();
+
+        for (long i = 0; i < n; i++) op();
+
+        t = Profiler::time() - start;
+
+        if (t >= minTime) break;
+
+        n *= 2;
+    }
+
+    for (int r = 0; r < 2; r++)
+    {
+        double start = Profiler::time();
+
+        for (long i = 0; i < n; i++) op();
+
+        t = GSL_MIN_DBL(t, Profiler::time() - start);
+    }
+
+    return t / n;
+}
+
+/**
+ * time an operation of a kernel, which makes nOp calls of it
+ */
+template <typename F>
+static void bench(std::vector<BenchResult>& results,
+                  const BenchPara& para,
+                  const char* kernel,
+                  const int size,
+                  const int nThread,
+                  const double bytes,
+                  const double flops,
+                  F op,
+                  const int nOp = 1)
+{
+    if (strstr(kernel, para.kernel.c_str()) == NULL) return;
+
+    BenchResult result;
+
+    result.kernel = kernel;
+    result.size = size;
+    result.nThread = nThread;
+    result.ns = timeOp(op, para.minTime) * 1e9 / nOp;
+    result.bytes = bytes;
+    result.flops = flops;
+
+    fprintf(stderr,
+            "%-32s size %4d threads %3d : %14.1f ns/op\n",
+            kernel,
+            size,
+            nThread,
+            result.ns);
+
+    results.push_back(result);
+}
+
+/**
+ * time a kernel run by a single thread, as nThread threads call it on their
+ * own data concurrently
+ */
+template <typename F>
+static void benchBatch(std::vector<BenchResult>& results,
+                       const BenchPara& para,
+                       const char* kernel,
+                       const int size,
+                       const int nThread,
+                       const double bytes,
+                       const double flops,
+                       F op)
+{
+    int nBatch = nThread * BENCH_BATCH_PER_THREAD;
+
+    // one operation is one call of the kernel
+
+    bench(results, para, kernel, size, nThread, bytes, flops, [&]()
+    {
+        #pragma omp parallel for num_threads(nThread)
+        for (int i = 0; i < nBatch; i++)
+            op(omp_get_thread_num());
+    }, nBatch);
+}
+
+static void randomise(gsl_rng* engine,
+                      Complex* dst,
+                      const size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        dst[i] = COMPLEX(gsl_ran_gaussian(engine, 1), gsl_ran_gaussian(engine, 1));
+}
+
+static void benchSize(std::vector<BenchResult>& results,
+                      const BenchPara& para,
+                      const int size,
+                      const std::vector<int>& nThreads)
+{
+    gsl_rng* engine = gsl_rng_alloc(gsl_rng_mt19937);
+
+    gsl_rng_set(engine, BENCH_SEED + size);
+
+    int pf = 2;
+    int r = size / 2 - 1;
+
+    // the pixels of the non-redundant half of an image within radius r
+
+    std::vector<int> iCol, iRow, iColPad, iRowPad, iPxl, iSig;
+
+    for (int j = -size / 2; j < size / 2; j++)
+        for (int i = 0; i <= size / 2; i++)
+            if (QUAD(i, j) < QUAD(r, 0))
+            {
+                iCol.push_back(i);
+                iRow.push_back(j);
+                iColPad.push_back(i * pf);
+                iRowPad.push_back(j * pf);
+                iPxl.push_back(iPxl.size());
+                iSig.push_back(AROUND(NORM(i, j)));
+            }
+
+    int m = iCol.size();
+    int n = BENCH_N_IMAGE;
+
+    int maxThread = *std::max_element(nThreads.begin(), nThreads.end());
+
+    Complex* dat = (Complex*)TSFFTW_malloc((size_t)n * m * sizeof(Complex));
+    Complex* pri = (Complex*)TSFFTW_malloc((size_t)m * sizeof(Complex));
+    RFLOAT* ctf = (RFLOAT*)TSFFTW_malloc((size_t)n * m * sizeof(RFLOAT));
+    RFLOAT* sigRcp = (RFLOAT*)TSFFTW_malloc((size_t)n * m * sizeof(RFLOAT));
+    RFLOAT* dvp = (RFLOAT*)TSFFTW_malloc((size_t)n * maxThread * sizeof(RFLOAT));
+
+    randomise(engine, dat, (size_t)n * m);
+    randomise(engine, pri, m);
+
+    for (size_t i = 0; i < (size_t)n * m; i++)
+    {
+        ctf[i] = gsl_ran_flat(engine, -1, 1);
+        sigRcp[i] = gsl_ran_flat(engine, 0.5, 2);
+    }
+
+    Image img2D(size, size, FT_SPACE);
+    randomise(engine, &img2D[0], img2D.sizeFT());
+
+    Volume vol3D(size, size, size, FT_SPACE);
+    randomise(engine, &vol3D[0], vol3D.sizeFT());
+
+    Projector proj2D, proj3D;
+
+    proj2D.setMode(MODE_2D);
+    proj2D.setPf(pf);
+    proj2D.setInterp(LINEAR_INTERP);
+    proj2D.setProjectee(img2D.copyImage(), maxThread);
+    proj2D.setMaxRadius(r);
+
+    proj3D.setMode(MODE_3D);
+    proj3D.setPf(pf);
+    proj3D.setInterp(LINEAR_INTERP);
+    proj3D.setProjectee(vol3D.copyVolume(), maxThread);
+    proj3D.setMaxRadius(r);
+
+    dmat22 rot2D;
+    dmat33 rot3D;
+
+    rotate2D(rot2D, 0.3);
+    rotate3D(rot3D, 0.3, 0.6, 0.9);
+
+    Complex* img = (Complex*)TSFFTW_malloc((size_t)m * maxThread * sizeof(Complex));
+    RFLOAT* ctfImg = (RFLOAT*)TSFFTW_malloc((size_t)m * maxThread * sizeof(RFLOAT));
+
+    Symmetry sym("O");
+
+    Symmetry c1("C1");
+
+    for (size_t t = 0; t < nThreads.size(); t++)
+    {
+        int nThread = nThreads[t];
+
+        double bytesN = (double)n * m * (sizeof(Complex) + 2 * sizeof(RFLOAT)) + (double)m * sizeof(Complex);
+        double bytesM = (double)m * (2 * sizeof(Complex) + 2 * sizeof(RFLOAT));
+
+        benchBatch(results, para, "logDataVSPrior_m_n_huabin", size, nThread, bytesN, (double)n * m * BENCH_FLOP_DATA_VS_PRIOR, [&](const int tid)
+        {
+            logDataVSPrior_m_n_huabin(dat, pri, ctf, sigRcp, n, m, dvp + tid * n);
+        });
+
+#ifdef ENABLE_SIMD_256
+        benchBatch(results, para, "logDataVSPrior_m_n_huabin_SIMD256", size, nThread, bytesN, (double)n * m * BENCH_FLOP_DATA_VS_PRIOR, [&](const int tid)
+        {
+            logDataVSPrior_m_n_huabin_SIMD256(dat, pri, ctf, sigRcp, n, m, dvp + tid * n);
+        });
+#endif
+
+#ifdef ENABLE_SIMD_512
+        benchBatch(results, para, "logDataVSPrior_m_n_huabin_SIMD512", size, nThread, bytesN, (double)n * m * BENCH_FLOP_DATA_VS_PRIOR, [&](const int tid)
+        {
+            logDataVSPrior_m_n_huabin_SIMD512(dat, pri, ctf, sigRcp, n, m, dvp + tid * n);
+        });
+#endif
+
+        benchBatch(results, para, "logDataVSPrior_m_huabin", size, nThread, bytesM, (double)m * BENCH_FLOP_DATA_VS_PRIOR, [&](const int tid)
+        {
+            dvp[tid * n] = logDataVSPrior_m_huabin(dat + (size_t)tid * m, pri, ctf + (size_t)tid * m, sigRcp + (size_t)tid * m, m);
+        });
+
+#ifdef ENABLE_SIMD_256
+        benchBatch(results, para, "logDataVSPrior_m_huabin_SIMD256", size, nThread, bytesM, (double)m * BENCH_FLOP_DATA_VS_PRIOR, [&](const int tid)
+        {
+            dvp[tid * n] = logDataVSPrior_m_huabin_SIMD256(dat + (size_t)tid * m, pri, ctf + (size_t)tid * m, sigRcp + (size_t)tid * m, m);
+        });
+#endif
+
+#ifdef ENABLE_SIMD_512
+        benchBatch(results, para, "logDataVSPrior_m_huabin_SIMD512", size, nThread, bytesM, (double)m * BENCH_FLOP_DATA_VS_PRIOR, [&](const int tid)
+        {
+            dvp[tid * n] = logDataVSPrior_m_huabin_SIMD512(dat + (size_t)tid * m, pri, ctf + (size_t)tid * m, sigRcp + (size_t)tid * m, m);
+        });
+#endif
+
+        // projections of a batch of images, as in expectation
+
+        benchBatch(results, para, "Projector::project 2D", size, nThread, (double)m * (sizeof(Complex) + 2 * sizeof(int)), 0, [&](const int tid)
+        {
+            proj2D.project(img + (size_t)tid * m, rot2D, &iCol[0], &iRow[0], m, 1);
+        });
+
+        benchBatch(results, para, "Projector::project 3D", size, nThread, (double)m * (sizeof(Complex) + 2 * sizeof(int)), 0, [&](const int tid)
+        {
+            proj3D.project(img + (size_t)tid * m, rot3D, &iCol[0], &iRow[0], m, 1);
+        });
+
+        bench(results, para, "translate", size, nThread, (double)m * (sizeof(Complex) + 2 * sizeof(int)), 0, [&]()
+        {
+            translate(img, 3.5, -2.5, size, size, &iCol[0], &iRow[0], m, nThread);
+        });
+
+        benchBatch(results, para, "CTF", size, nThread, (double)m * (sizeof(RFLOAT) + 2 * sizeof(int)), 0, [&](const int tid)
+        {
+            CTF(ctfImg + (size_t)tid * m, 1.3, 300, 20000, 21000, 0.5, 2.7, 0.07, 0, size, size, &iCol[0], &iRow[0], m);
+        });
+
+        // FFT of an image and a volume, forward and backward
+
+        Image imgRL(size, size, RL_SPACE);
+        Volume volRL(size, size, size, RL_SPACE);
+
+        for (size_t i = 0; i < imgRL.sizeRL(); i++) imgRL(i) = gsl_ran_gaussian(engine, 1);
+        for (size_t i = 0; i < volRL.sizeRL(); i++) volRL(i) = gsl_ran_gaussian(engine, 1);
+
+        FFT fft;
+
+        double n2 = (double)size * size;
+        double n3 = (double)size * size * size;
+
+        bench(results, para, "FFT 2D", size, nThread, 2 * (n2 * sizeof(RFLOAT) + imgRL.sizeFT() * sizeof(Complex)), 2 * 2.5 * n2 * log2(n2), [&]()
+        {
+            fft.fw(imgRL, nThread);
+            fft.bw(imgRL, nThread);
+        });
+
+        bench(results, para, "FFT 3D", size, nThread, 2 * (n3 * sizeof(RFLOAT) + volRL.sizeFT() * sizeof(Complex)), 2 * 2.5 * n3 * log2(n3), [&]()
+        {
+            fft.fw(volRL, nThread);
+            fft.bw(volRL, nThread);
+        });
+
+        // the symmetrised volume is also the counterpart of vol3D in FSC, thus built whichever kernels are benched
+
+        Volume symVol;
+
+        SYMMETRIZE_FT(symVol, vol3D, sym, r, LINEAR_INTERP, nThread);
+
+        bench(results, para, "SYMMETRIZE_FT O", size, nThread, (double)sym.nSymmetryElement() * 2 * vol3D.sizeFT() * sizeof(Complex), 0, [&]()
+        {
+            SYMMETRIZE_FT(symVol, vol3D, sym, r, LINEAR_INTERP, nThread);
+        });
+
+        vec avg = vec::Zero(r + 1);
+
+        bench(results, para, "shellAverage", size, nThread, (double)vol3D.sizeFT() * sizeof(Complex), 0, [&]()
+        {
+            shellAverage(avg, vol3D, REAL, r, nThread);
+        });
+
+        // FSC is serial, thus only timed once
+
+        if (t == 0)
+        {
+            vec fsc = vec::Zero(r + 1);
+
+            bench(results, para, "FSC", size, 1, (double)2 * vol3D.sizeFT() * sizeof(Complex), (double)vol3D.sizeFT() * 14, [&]()
+            {
+                FSC(fsc, vol3D, symVol);
+            });
+        }
+
+        // insertion and reconstruction of a hemisphere of a single process
+
+        if ((strstr("Reconstructor::insertP", para.kernel.c_str()) == NULL) &&
+            (strstr("Reconstructor::reconstruct", para.kernel.c_str()) == NULL))
+            continue;
+
+        Reconstructor reco(MODE_3D, size, size, pf, &c1);
+
+        reco.setMPIEnv(2, HEMI_A_LEAD, MPI_COMM_SELF, MPI_COMM_SELF);
+        reco.allocSpace(nThread);
+        reco.setPreCal(m, &iColPad[0], &iRowPad[0], &iPxl[0], &iSig[0]);
+        reco.setMaxRadius(r);
+        reco.setFSC(vec::Constant(r + 1, 0.9));
+
+        for (int i = 0; i < m * maxThread; i++)
+            ctfImg[i] = 1;
+
+#ifdef RECONSTRUCTOR_INSERT_BUFFERED
+        // each batch is flushed within the timing, thus the records do not pile up and the scatter is counted
+
+        int nBatch = nThread * BENCH_BATCH_PER_THREAD;
+
+        bench(results, para, "Reconstructor::insertP", size, nThread, (double)m * (sizeof(Complex) + sizeof(RFLOAT)), 0, [&]()
+        {
+            #pragma omp parallel for num_threads(nThread)
+            for (int i = 0; i < nBatch; i++)
+            {
+                int tid = omp_get_thread_num();
+
+                reco.insertP(img + (size_t)tid * m, ctfImg + (size_t)tid * m, rot3D, 1);
+            }
+
+            reco.flushInsertP();
+        }, nBatch);
+#else
+        benchBatch(results, para, "Reconstructor::insertP", size, nThread, (double)m * (sizeof(Complex) + sizeof(RFLOAT)), 0, [&](const int tid)
+        {
+            reco.insertP(img + (size_t)tid * m, ctfImg + (size_t)tid * m, rot3D, 1);
+        });
+#endif
+
+        reco.prepareTF(nThread);
+
+        Volume ref;
+
+        bench(results, para, "Reconstructor::reconstruct", size, nThread, 0, 0, [&]()
+        {
+            reco.reconstruct(ref, nThread);
+        });
+    }
+
+    TSFFTW_free(dat);
+    TSFFTW_free(pri);
+    TSFFTW_free(ctf);
+    TSFFTW_free(sigRcp);
+    TSFFTW_free(dvp);
+    TSFFTW_free(img);
+    TSFFTW_free(ctfImg);
+
+    gsl_rng_free(engine);
+}
+
+static std::string resultKey(const std::string& kernel,
+                             const int size,
+                             const int nThread)
+{
+    char key[FILE_NAME_LENGTH];
+
+    snprintf(key, sizeof(key), "%s %d %d", kernel.c_str(), size, nThread);
+
+    return key;
+}
+
+int main(int argc, char* argv[])
+{
+    int opt;
+    char* output = NULL;
+    char* baseline = NULL;
+    char* sizeList = NULL;
+    char* threadList = NULL;
+
+    BenchPara para;
+
+    para.kernel = "";
+    para.minTime = 0.2;
+
+    double tolerance = 0.1;
+
+    int option_index = 0;
+
+    while((opt = getopt_long(argc, argv, "o:j:", long_options, &option_index)) != -1)
+    {
+        switch(opt)
+        {
+            case('o'):
+                output = optarg;
+                break;
+            case('j'):
+                threadList = optarg;
+                break;
+            case('s'):
+                sizeList = optarg;
+                break;
+            case('k'):
+                para.kernel = optarg;
+                break;
+            case('t'):
+                para.minTime = atof(optarg);
+                break;
+            case('b'):
+                baseline = optarg;
+                break;
+            case('r'):
+                tolerance = atof(optarg);
+                break;
+            case('h'):
+                usage(EXIT_SUCCESS);
+                break;
+            default:
+                usage(EXIT_FAILURE);
+        }
+    }
+
+    std::vector<int> sizes = parseList((sizeList == NULL) ? "64,128" : sizeList);
+
+    std::vector<int> nThreads;
+
+    if (threadList == NULL)
+    {
+        nThreads.push_back(1);
+
+        if (omp_get_max_threads() > 1) nThreads.push_back(omp_get_max_threads());
+    }
+    else
+        nThreads = parseList(threadList);
+
+    MPI_Init(&argc, &argv);
+
+    loggerInit(argc, argv);
+
+    std::vector<BenchResult> results;
+
+    for (size_t i = 0; i < sizes.size(); i++)
+        benchSize(results, para, sizes[i], nThreads);
+
+    // the results of the baseline, indexed by kernel, size and threads
+
+    std::map<std::string, double> base;
+
+    if (baseline != NULL)
+    {
+        std::ifstream file(baseline);
+
+        Json::Reader reader;
+        Json::Value root;
+
+        if (!file.is_open() || !reader.parse(file, root))
+        {
+            fprintf(stderr, "Fail to Read Baseline [%s]\n", baseline);
+
+            abort();
+        }
+
+        const Json::Value& entries = root["results"];
+
+        for (Json::ArrayIndex i = 0; i < entries.size(); i++)
+            base[resultKey(entries[i]["kernel"].asString(),
+                           entries[i]["size"].asInt(),
+                           entries[i]["threads"].asInt())] = entries[i]["ns_per_op"].asDouble();
+    }
+
+    Json::Value root;
+
+    char version[FILE_NAME_LENGTH];
+
+    sprintf(version,
+            "%d.%d.%d",
+            THUNDER_VERSION_MAJOR,
+            THUNDER_VERSION_MINOR,
+            THUNDER_VERSION_ADDIT);
+
+    root["version"] = version;
+
+#ifdef SINGLE_PRECISION
+    root["precision"] = "single";
+#else
+    root["precision"] = "double";
+#endif
+
+#ifdef ENABLE_SIMD_512
+    root["simd"] = "AVX512";
+#elif defined ENABLE_SIMD_256
+    root["simd"] = "AVX256";
+#else
+    root["simd"] = "none";
+#endif
+
+    root["results"] = Json::Value(Json::arrayValue);
+
+    int nRegression = 0;
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchResult& result = results[i];
+
+        Json::Value entry;
+
+        entry["kernel"] = result.kernel;
+        entry["size"] = result.size;
+        entry["threads"] = result.nThread;
+        entry["ns_per_op"] = result.ns;
+
+        if (result.bytes > 0) entry["GB_per_s"] = result.bytes / result.ns;
+        if (result.flops > 0) entry["GFLOP_per_s"] = result.flops / result.ns;
+
+        std::map<std::string, double>::const_iterator it = base.find(resultKey(result.kernel, result.size, result.nThread));
+
+        if (it != base.end())
+        {
+            double change = result.ns / it->second - 1;
+
+            entry["baseline_ns_per_op"] = it->second;
+            entry["change"] = change;
+            entry["regression"] = (change > tolerance);
+
+            if (change > tolerance)
+            {
+                nRegression += 1;
+
+                fprintf(stderr,
+                        "REGRESSION %s size %d threads %d : %.1f ns/op against %.1f ns/op (%+.1f%%)\n",
+                        result.kernel.c_str(),
+                        result.size,
+                        result.nThread,
+                        result.ns,
+                        it->second,
+                        change * 100);
+            }
+        }
+
+        root["results"].append(entry);
+    }
+
+    Json::StyledWriter writer;
+
+    if (output == NULL)
+        std::cout << writer.write(root);
+    else
+    {
+        std::ofstream file(output);
+
+        file << writer.write(root);
+    }
+
+    MPI_Finalize();
+
+    return (nRegression > 0) ? 1 : 0;
+}
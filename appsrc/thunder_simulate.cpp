@@ -0,0 +1,553 @@
+/** @file
+ *  @copyright THUNDER Non-Commercial Software License Agreement
+ *
+ *  @brief thunder_simulate.cpp generates a synthetic dataset of particles from a reference. Each particle is a projection of the symmetrized reference in a random pose with a random shift, modulated by the CTF of its micrograph and buried in coloured noise. The particles of each micrograph are written into a .mrcs stack, and a .thu database of them is written along with a .thu database of the ground-truth poses and shifts.
+ *
+ */
+
+#include <unistd.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <iostream>
+
+#include "Config.h"
+#include "Logging.h"
+#include "Macro.h"
+#include "ImageFile.h"
+#include "Volume.h"
+#include "Projector.h"
+#include "FFT.h"
+#include "CTF.h"
+#include "Spectrum.h"
+#include "Symmetry.h"
+#include "Transformation.h"
+#include "Euler.h"
+#include "Database.h"
+
+INITIALIZE_EASYLOGGINGPP
+
+#define PROGRAM_NAME "thunder_simulate"
+
+/**
+ * the number of particles generated in memory before written out
+ */
+#define SIMULATE_BLOCK 1024
+
+#define emit_try_help() \
+do \
+    { \
+        fprintf(stderr, "Try '%s --help' for more information.\n", \
+                PROGRAM_NAME); \
+    } \
+while(0)
+
+#define HELP_OPTION_DESCRIPTION "--help     display this help\n"
+
+void usage(int status)
+{
+    if (status != EXIT_SUCCESS)
+    {
+        emit_try_help ();
+    }
+    else
+    {
+        printf("Usage: %s [OPTION]...\n", PROGRAM_NAME);
+
+        fputs("Generate a synthetic dataset of particles from a reference.\n", stdout);
+
+        fputs("-o    set the directory of output files.\n", stdout);
+        fputs("-j    set the thread-number to carry out work.\n", stdout);
+        fputs("--input    set the directory of the reference.\n", stdout);
+        fputs("--pixelsize    set the pixelsize.\n", stdout);
+        fputs("--nparticle    set the number of particles.\n", stdout);
+        fputs("--sym    set the symmetry of the reference, C1 by default.\n", stdout);
+        fputs("--snr    set the ratio of the power of projections to the power of noise in every shell, 0.1 by default.\n", stdout);
+        fputs("--shift    set the standard deviation of shifts in pixels, 3 by default.\n", stdout);
+        fputs("--permic    set the number of particles of a micrograph, 100 by default.\n", stdout);
+        fputs("--voltage    set the voltage in kV, 300 by default.\n", stdout);
+        fputs("--cs    set the spherical aberration in mm, 2.7 by default.\n", stdout);
+        fputs("--ac    set the amplitude contrast, 0.1 by default.\n", stdout);
+        fputs("--defocus    set the mean of defocus of micrographs in Angstrom, 20000 by default.\n", stdout);
+        fputs("--defocusstd    set the standard deviation of defocus of micrographs in Angstrom, 5000 by default.\n", stdout);
+        fputs("--astigmatism    set the standard deviation of astigmatism of micrographs in Angstrom, 500 by default.\n", stdout);
+        fputs("--seed    set the seed of random numbers, 0 by default.\n", stdout);
+
+        fputs(HELP_OPTION_DESCRIPTION, stdout);
+
+        fputs("Note: o, input, pixelsize and nparticle are indispensable. The particles are written into Particles_[micrograph].mrcs, and their databases are Simulate.thu and Simulate_Truth.thu, all under the directory of output files.\n", stdout);
+    }
+    exit(status);
+}
+
+static const struct option long_options[] =
+{
+    {"input", required_argument, NULL, 'i'},
+    {"pixelsize", required_argument, NULL, 'p'},
+    {"nparticle", required_argument, NULL, 'n'},
+    {"sym", required_argument, NULL, 's'},
+    {"snr", required_argument, NULL, 'r'},
+    {"shift", required_argument, NULL, 't'},
+    {"permic", required_argument, NULL, 'm'},
+    {"voltage", required_argument, NULL, 'v'},
+    {"cs", required_argument, NULL, 'c'},
+    {"ac", required_argument, NULL, 'a'},
+    {"defocus", required_argument, NULL, 'd'},
+    {"defocusstd", required_argument, NULL, 'e'},
+    {"astigmatism", required_argument, NULL, 'g'},
+    {"seed", required_argument, NULL, 'x'},
+    {"help", no_argument, NULL, 'h'},
+    {NULL, 0, NULL, 0}
+};
+
+/**
+ * append a line of a particle to a .thu database
+ */
+static void appendLine(string& dst,
+                       const CTFAttr& ctfAttr,
+                       const char* path,
+                       const char* micrographPath,
+                       const dvec4& quat,
+                       const dvec2& tran)
+{
+    char line[FILE_LINE_LENGTH];
+
+    snprintf(line,
+             FILE_LINE_LENGTH,
+             "%18.9lf %18.9lf %18.9lf %18.9lf %18.9lf %18.9lf %18.9lf \
+             %s %s %18.9lf %18.9lf \
+             %6d %6d \
+             %18.9lf %18.9lf %18.9lf %18.9lf \
+             %18.9lf %18.9lf %18.9lf \
+             %18.9lf %18.9lf %18.9lf %18.9lf \
+             %18.9lf %18.9lf \
+             %18.9lf\n",
+             ctfAttr.voltage,
+             ctfAttr.defocusU,
+             ctfAttr.defocusV,
+             ctfAttr.defocusTheta,
+             ctfAttr.Cs,
+             ctfAttr.amplitudeContrast,
+             ctfAttr.phaseShift,
+             path,
+             micrographPath,
+             0.0,
+             0.0,
+             1,
+             0,
+             quat(0),
+             quat(1),
+             quat(2),
+             quat(3),
+             0.0,
+             0.0,
+             0.0,
+             tran(0),
+             tran(1),
+             0.0,
+             0.0,
+             1.0,
+             0.0,
+             0.0);
+
+    dst.append(line);
+}
+
+int main(int argc, char* argv[])
+{
+    int opt;
+    char* output = NULL;
+    char* input = NULL;
+    const char* sym = "C1";
+
+    double pixelSize = 0;
+
+    long nParticle = 0;
+
+    int nThread = 1;
+
+    double snr = 0.1;
+    double shift = 3;
+    int perMic = 100;
+    double voltage = 300;
+    double Cs = 2.7;
+    double ac = 0.1;
+    double defocus = 20000;
+    double defocusStd = 5000;
+    double astigmatism = 500;
+
+    unsigned long seed = 0;
+
+    int option_index = 0;
+
+    if(optind == argc)
+    {
+        usage(EXIT_FAILURE);
+    }
+
+    while((opt = getopt_long(argc, argv, "o:j:", long_options, &option_index)) != -1)
+    {
+        switch(opt)
+        {
+            case('o'):
+                output = optarg;
+                break;
+            case('j'):
+                nThread = atoi(optarg);
+                break;
+            case('i'):
+                input = optarg;
+                break;
+            case('p'):
+                pixelSize = atof(optarg);
+                break;
+            case('n'):
+                nParticle = atol(optarg);
+                break;
+            case('s'):
+                sym = optarg;
+                break;
+            case('r'):
+                snr = atof(optarg);
+                break;
+            case('t'):
+                shift = atof(optarg);
+                break;
+            case('m'):
+                perMic = atoi(optarg);
+                break;
+            case('v'):
+                voltage = atof(optarg);
+                break;
+            case('c'):
+                Cs = atof(optarg);
+                break;
+            case('a'):
+                ac = atof(optarg);
+                break;
+            case('d'):
+                defocus = atof(optarg);
+                break;
+            case('e'):
+                defocusStd = atof(optarg);
+                break;
+            case('g'):
+                astigmatism = atof(optarg);
+                break;
+            case('x'):
+                seed = strtoul(optarg, NULL, 10);
+                break;
+            case('h'):
+                usage(EXIT_SUCCESS);
+                break;
+            default:
+                usage(EXIT_FAILURE);
+        }
+    }
+
+    if ((output == NULL) ||
+        (input == NULL) ||
+        (pixelSize <= 0) ||
+        (nParticle <= 0) ||
+        (perMic <= 0) ||
+        (snr <= 0) ||
+        (nThread <= 0))
+        usage(EXIT_FAILURE);
+
+    loggerInit(argc, argv);
+
+    TSFFTW_init_threads();
+
+    CLOG(INFO, "LOGGER_SYS") << "Reading Reference";
+
+    ImageFile imf(input, "rb");
+    imf.readMetaData();
+
+    Volume ref;
+    imf.readVolume(ref);
+
+    int size = ref.nColRL();
+
+    if ((ref.nRowRL() != size) || (ref.nSlcRL() != size))
+    {
+        CLOG(FATAL, "LOGGER_SYS") << "Reference Shall be a Cube"
+                                  << ": nCol = " << ref.nColRL()
+                                  << ", nRow = " << ref.nRowRL()
+                                  << ", nSlc = " << ref.nSlcRL();
+
+        abort();
+    }
+
+    int r = size / 2 - 1;
+
+    FFT fft;
+    fft.fw(ref, nThread);
+    ref.clearRL();
+
+    CLOG(INFO, "LOGGER_SYS") << "Symmetrizing Reference by " << sym;
+
+    Symmetry symmetry(sym);
+
+    Volume symRef;
+    SYMMETRIZE_FT(symRef, ref, symmetry, r, LINEAR_INTERP, nThread);
+
+    // the noise of a shell has the power of projections in it over the SNR,
+    // the power of a central slice in a shell is that of the volume
+
+    vec sigma = vec::Zero(r + 1);
+    shellAverage(sigma, symRef, ABS2, r, nThread);
+    sigma /= snr;
+
+    Projector proj;
+
+    proj.setMode(MODE_3D);
+    proj.setPf(2);
+    proj.setInterp(LINEAR_INTERP);
+    proj.setProjectee(symRef.copyVolume(), nThread);
+    proj.setMaxRadius(r);
+
+    symRef.clearFT();
+    ref.clearFT();
+
+    // the pixels within the Nyquist frequency
+
+    vector<int> iCol, iRow, iPxl, iSig;
+
+    Image img(size, size, FT_SPACE);
+
+    for (int j = -size / 2; j < size / 2; j++)
+        for (int i = 0; i <= size / 2; i++)
+            if (QUAD(i, j) < TSGSL_pow_2(r))
+            {
+                iCol.push_back(i);
+                iRow.push_back(j);
+                iPxl.push_back(img.iFTHalf(i, j));
+                iSig.push_back(GSL_MIN_INT(AROUND(NORM(i, j)), r - 1));
+            }
+
+    int nPxl = iCol.size();
+
+    long nMic = (nParticle + perMic - 1) / perMic;
+
+    // the CTF of each micrograph is drawn in order, thus it does not depend on
+    // the number of threads
+
+    vector<CTFAttr> ctfAttr(nMic);
+
+    gsl_rng* engine = gsl_rng_alloc(gsl_rng_mt19937);
+
+    gsl_rng_set(engine, seed);
+
+    for (long mic = 0; mic < nMic; mic++)
+    {
+        double df = defocus + gsl_ran_gaussian(engine, defocusStd);
+        double dfAst = gsl_ran_gaussian(engine, astigmatism);
+
+        ctfAttr[mic].voltage = voltage * 1000;
+        ctfAttr[mic].defocusU = df + dfAst / 2;
+        ctfAttr[mic].defocusV = df - dfAst / 2;
+        ctfAttr[mic].defocusTheta = gsl_ran_flat(engine, 0, M_PI);
+        ctfAttr[mic].Cs = Cs * 1e7;
+        ctfAttr[mic].amplitudeContrast = ac;
+        ctfAttr[mic].phaseShift = 0;
+    }
+
+    gsl_rng_free(engine);
+
+    char filename[FILE_NAME_LENGTH];
+
+    if (snprintf(filename, sizeof(filename), "%sSimulate.thu", output) >= (int)sizeof(filename))
+    {
+        REPORT_ERROR("TOO LONG PATH OF OUTPUT");
+
+        abort();
+    }
+
+    FILE* db = fopen(filename, "w");
+
+    if (snprintf(filename, sizeof(filename), "%sSimulate_Truth.thu", output) >= (int)sizeof(filename))
+    {
+        REPORT_ERROR("TOO LONG PATH OF OUTPUT");
+
+        abort();
+    }
+
+    FILE* truth = fopen(filename, "w");
+
+    if ((db == NULL) || (truth == NULL))
+    {
+        REPORT_ERROR("FAIL TO OPEN DATABASE");
+
+        abort();
+    }
+
+    // a block holds whole micrographs, thus each stack is written at once
+
+    int micPerBlock = GSL_MAX_INT(1, SIMULATE_BLOCK / perMic);
+
+    int blockSize = micPerBlock * perMic;
+
+    vector<Image> imgs(blockSize);
+    vector<Image*> imgPtr(blockSize);
+
+    vector<dvec4> quats(blockSize);
+    vector<dvec2> trans(blockSize);
+
+    for (int i = 0; i < blockSize; i++)
+        imgPtr[i] = &imgs[i];
+
+    for (long micBegin = 0; micBegin < nMic; micBegin += micPerBlock)
+    {
+        long micEnd = GSL_MIN(micBegin + micPerBlock, nMic);
+
+        long begin = micBegin * perMic;
+        long end = GSL_MIN(micEnd * perMic, nParticle);
+
+        int n = end - begin;
+
+        CLOG(INFO, "LOGGER_SYS") << "Generating Particle " << begin + 1 << " to " << end << " of " << nParticle;
+
+        #pragma omp parallel num_threads(nThread)
+        {
+            gsl_rng* engine = gsl_rng_alloc(gsl_rng_mt19937);
+
+            Complex* dat = (Complex*)TSFFTW_malloc(nPxl * sizeof(Complex));
+            Complex* tran = (Complex*)TSFFTW_malloc(nPxl * sizeof(Complex));
+            RFLOAT* ctf = (RFLOAT*)TSFFTW_malloc(nPxl * sizeof(RFLOAT));
+
+            #pragma omp for schedule(dynamic)
+            for (int k = 0; k < n; k++)
+            {
+                long id = begin + k;
+
+                // each particle has its own seed, thus the dataset does not
+                // depend on the number of threads
+
+                gsl_rng_set(engine, seed + 1 + id);
+
+                const CTFAttr& attr = ctfAttr[id / perMic];
+
+                dvec4 quat;
+
+                for (int i = 0; i < 4; i++)
+                    quat(i) = gsl_ran_gaussian(engine, 1);
+
+                quat /= quat.norm();
+
+                if (quat(0) < 0) quat = -quat;
+
+                dmat33 rot;
+                rotate3D(rot, quat);
+
+                quats[k] = quat;
+                trans[k] = dvec2(gsl_ran_gaussian(engine, shift),
+                                 gsl_ran_gaussian(engine, shift));
+
+                proj.project(dat, rot, &iCol[0], &iRow[0], nPxl, 1);
+
+                CTF(ctf,
+                    pixelSize,
+                    attr.voltage,
+                    attr.defocusU,
+                    attr.defocusV,
+                    attr.defocusTheta,
+                    attr.Cs,
+                    attr.amplitudeContrast,
+                    attr.phaseShift,
+                    size,
+                    size,
+                    &iCol[0],
+                    &iRow[0],
+                    nPxl);
+
+                translate(tran, trans[k](0), trans[k](1), size, size, &iCol[0], &iRow[0], nPxl, 1);
+
+                imgs[k].alloc(size, size, FT_SPACE);
+
+                SET_0_FT(imgs[k]);
+
+                for (int i = 0; i < nPxl; i++)
+                {
+                    RFLOAT s = TS_SQRT(sigma(iSig[i]) / 2);
+
+                    imgs[k][iPxl[i]] = dat[i] * tran[i] * ctf[i]
+                                     + COMPLEX(gsl_ran_gaussian(engine, s),
+                                               gsl_ran_gaussian(engine, s));
+                }
+            }
+
+            TSFFTW_free(dat);
+            TSFFTW_free(tran);
+            TSFFTW_free(ctf);
+
+            gsl_rng_free(engine);
+        }
+
+#ifdef FFT_PLAN_CACHE
+        FFT::bwBatch(&imgPtr[0], n, nThread);
+#else
+        for (int k = 0; k < n; k++)
+            fft.bw(imgs[k], nThread);
+#endif
+
+        #pragma omp parallel for schedule(dynamic) num_threads(nThread)
+        for (long mic = micBegin; mic < micEnd; mic++)
+        {
+            char stack[FILE_NAME_LENGTH];
+
+            if (snprintf(stack, sizeof(stack), "%sParticles_%06ld.mrcs", output, mic + 1) >= (int)sizeof(stack))
+            {
+                REPORT_ERROR("TOO LONG PATH OF OUTPUT");
+
+                abort();
+            }
+
+            int first = mic * perMic - begin;
+            int last = GSL_MIN((mic + 1) * perMic, nParticle) - begin;
+
+            ImageFile stackFile;
+
+            stackFile.openStack(stack, size, last - first, pixelSize);
+
+            for (int k = first; k < last; k++)
+                stackFile.writeStack(imgs[k], k - first);
+
+            stackFile.closeStack();
+        }
+
+        string dbBuf, truthBuf;
+
+        char path[FILE_WORD_LENGTH];
+        char micrographPath[FILE_WORD_LENGTH];
+
+        for (int k = 0; k < n; k++)
+        {
+            long mic = (begin + k) / perMic;
+
+            snprintf(path,
+                     sizeof(path),
+                     "%06ld@Particles_%06ld.mrcs",
+                     (begin + k) % perMic + 1,
+                     mic + 1);
+
+            snprintf(micrographPath,
+                     sizeof(micrographPath),
+                     "Micrograph_%06ld.mrc",
+                     mic + 1);
+
+            appendLine(dbBuf, ctfAttr[mic], path, micrographPath, dvec4(0, 0, 0, 0), dvec2(0, 0));
+            appendLine(truthBuf, ctfAttr[mic], path, micrographPath, quats[k], trans[k]);
+        }
+
+        fputs(dbBuf.c_str(), db);
+        fputs(truthBuf.c_str(), truth);
+    }
+
+    fclose(db);
+    fclose(truth);
+
+    CLOG(INFO, "LOGGER_SYS") << nParticle << " Particles of " << nMic << " Micrographs Generated";
+
+    TSFFTW_cleanup_threads();
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+/** @file
+ *  @copyright THUNDER Non-Commercial Software License Agreement
+ *
+ *  @brief thunder_thu2thb.cpp converts a .thu file into a binary database (.thb), which is memory-mapped by thunder and accessed without parsing. The parameters provided by users are directories of input and output files.
+ *
+ */
+
+#include <unistd.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <iostream>
+
+#include "Database.h"
+
+INITIALIZE_EASYLOGGINGPP
+
+#define PROGRAM_NAME "thunder_thu2thb"
+
+#define emit_try_help() \
+do \
+    { \
+        fprintf(stderr, "Try '%s --help' for more information.\n", \
+                PROGRAM_NAME); \
+    } \
+while(0)
+
+#define HELP_OPTION_DESCRIPTION "--help     display this help\n"
+
+void usage(int status)
+{
+    if (status != EXIT_SUCCESS)
+    {
+        emit_try_help ();
+    }
+    else
+    {
+        printf("Usage: %s [OPTION]...\n", PROGRAM_NAME);
+
+        fputs("Convert a .thu file into a binary database (.thb).\n", stdout);
+
+        fputs("-o    set the directory of output file.\n", stdout);
+        fputs("--input    set the directory of input .thu file.\n", stdout);
+
+        fputs(HELP_OPTION_DESCRIPTION, stdout);
+
+        fputs("Note: all parameters are indispensable.\n", stdout);
+
+    }
+    exit(status);
+}
+
+static const struct option long_options[] =
+{
+    {"input", required_argument, NULL, 'i'},
+    {"help", no_argument, NULL, 'h'},
+    {NULL, 0, NULL, 0}
+};
+
+int main(int argc, char* argv[])
+{
+    int opt;
+    char* output = NULL;
+    char* input = NULL;
+
+    int option_index = 0;
+
+    if(optind == argc)
+    {
+        usage(EXIT_FAILURE);
+    }
+
+    while((opt = getopt_long(argc, argv, "o:", long_options, &option_index)) != -1)
+    {
+        switch(opt)
+        {
+            case('o'):
+                output = optarg;
+                break;
+            case('i'):
+                input = optarg;
+                break;
+            case('h'):
+                usage(EXIT_SUCCESS);
+                break;
+            default:
+                usage(EXIT_FAILURE);
+        }
+
+    }
+
+    if ((input == NULL) || (output == NULL))
+        usage(EXIT_FAILURE);
+
+    loggerInit(argc, argv);
+
+    Database::convertDatabase(input, output);
+
+    return 0;
+}
@@ -88,4 +88,23 @@ void CTF(RFLOAT* dst,                       /**< [out] @f$I@f$ */
          const int nPxl                     /**< [in] @f$N@f$ */
          );
 
+/**
+ * @brief This function computes CTF values of certain pixels in Fourier space from per-pixel tables shared by all images, output in a float array @f$I@f$.
+ *
+ * @f$H_i@f$ is the spatial frequency of the i-th pixel and @f$\alpha_{g,i}@f$ its angle to X axis. The astigmatism term is expanded as @f$\cos(2[\alpha_g-\alpha_{\alpha st}])=\cos(2\alpha_g)\cos(2\alpha_{\alpha st})+\sin(2\alpha_g)\sin(2\alpha_{\alpha st})@f$ and the CTF is evaluated as @f$-\sin(\chi-\arcsin A)@f$, so that only one sine is needed for each pixel. The sine is vectorized in single precision under SIMD.
+ */
+void CTF(RFLOAT* dst,                       /**< [out] @f$I@f$ */
+         const RFLOAT voltage,              /**< [in] @f$V@f$ */
+         const RFLOAT defocusU,             /**< [in] @f$\Delta f_1@f$ */
+         const RFLOAT defocusV,             /**< [in] @f$\Delta f_2@f$ */
+         const RFLOAT theta,                /**< [in] @f$\alpha{_{\alpha st}}@f$ */
+         const RFLOAT Cs,                   /**< [in] @f$C_S@f$ */
+         const RFLOAT amplitudeContrast,    /**< [in] @f$A@f$ */
+         const RFLOAT phaseShift,           /**< [in] @f$\Delta\varphi@f$ */
+         const RFLOAT* frequency,           /**< [in] @f$H_i@f$ */
+         const RFLOAT* cos2Angle,           /**< [in] @f$\cos(2\alpha_{g,i})@f$ */
+         const RFLOAT* sin2Angle,           /**< [in] @f$\sin(2\alpha_{g,i})@f$ */
+         const int nPxl                     /**< [in] @f$N@f$ */
+         );
+
 #endif // CTF_H
@@ -0,0 +1,158 @@
+/*******************************************************************************
+ * Author: Mingxu Hu
+ * Dependency:
+ * Test:
+ * Execution:
+ * Description:
+ *
+ * Manual:
+ * ****************************************************************************/
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstring>
+#include <string>
+
+#include <mpi.h>
+
+#include "Config.h"
+#include "Macro.h"
+#include "Typedef.h"
+#include "Logging.h"
+#include "Precision.h"
+
+/**
+ * version of the layout of checkpoints, a checkpoint of another version is
+ * refused
+ */
+#define CHECKPOINT_VERSION 1
+
+/**
+ * Checkpoint is a buffer of binary states of a process. States are put in and
+ * got out in the same order. Buffers of all processes of a communicator are
+ * written into one file concurrently, each one led by its size, and each
+ * process reads back its own buffer.
+ */
+class Checkpoint
+{
+    private:
+
+        /**
+         * the size of the buffer in the first bytes, followed by states
+         */
+        std::string _buf;
+
+        /**
+         * the position of the next state to be got
+         */
+        size_t _pos;
+
+        /**
+         * abort if less than size bytes are left to be got
+         */
+        void check(const size_t size) const;
+
+    public:
+
+        Checkpoint();
+
+        template <typename T>
+        void put(const T& src)
+        {
+            _buf.append(reinterpret_cast<const char*>(&src), sizeof(T));
+        }
+
+        template <typename T>
+        void get(T& dst)
+        {
+            check(sizeof(T));
+
+            memcpy(&dst, &_buf[_pos], sizeof(T));
+
+            _pos += sizeof(T);
+        }
+
+        template <typename T>
+        void putArray(const T* src,
+                      const size_t n)
+        {
+            _buf.append(reinterpret_cast<const char*>(src), n * sizeof(T));
+        }
+
+        template <typename T>
+        void getArray(T* dst,
+                      const size_t n)
+        {
+            check(n * sizeof(T));
+
+            memcpy(dst, &_buf[_pos], n * sizeof(T));
+
+            _pos += n * sizeof(T);
+        }
+
+        /**
+         * put an Eigen matrix with its size
+         */
+        template <typename Derived>
+        void putMatrix(const Eigen::PlainObjectBase<Derived>& src)
+        {
+            put((long)src.rows());
+            put((long)src.cols());
+
+            putArray(src.data(), src.size());
+        }
+
+        template <typename Derived>
+        void getMatrix(Eigen::PlainObjectBase<Derived>& dst)
+        {
+            long rows, cols;
+
+            get(rows);
+            get(cols);
+
+            dst.resize(rows, cols);
+
+            getArray(dst.data(), dst.size());
+        }
+
+        /**
+         * put a vector of plain elements with its size
+         */
+        template <typename V>
+        void putVector(const V& src)
+        {
+            put((size_t)src.size());
+
+            if (src.size() > 0) putArray(&src[0], src.size());
+        }
+
+        template <typename V>
+        void getVector(V& dst)
+        {
+            size_t size;
+
+            get(size);
+
+            dst.resize(size);
+
+            if (size > 0) getArray(&dst[0], size);
+        }
+
+        /**
+         * write the buffers of all processes of the communicator into a file,
+         * which is first written to a temporary file and then renamed, thus a
+         * former checkpoint is kept if the writing fails
+         */
+        void write(const char* filename,
+                   MPI_Comm comm);
+
+        /**
+         * read the buffer of this process from a file written by write() with
+         * the same number of processes
+         */
+        void read(const char* filename,
+                  MPI_Comm comm);
+};
+
+#endif // CHECKPOINT_H
@@ -34,14 +34,24 @@
 
 //#define VERBOSE_LEVEL_4
 
+#define PROFILER_SCOPE_TIMER
+
+#define PARALLEL_NODE_AWARE
+
 #define FUNCTIONS_MKB_ORDER_0
 
 //#define FUNCTIONS_MKB_ORDER_2
 
+#define FFT_PLAN_CACHE
+
 #define IMG_VOL_BOUNDARY_NO_CHECK
 
 #define IMG_VOL_BOX_UNFOLD
 
+#define IMAGE_FILE_MMAP
+
+#define IMAGE_TRANSLATE_SEPARABLE
+
 //#define INTERP_CELL_UNFOLD
 
 #define MATRIX_BOUNDARY_NO_CHECK
@@ -98,6 +108,13 @@
 
 #define RECONSTRUCTOR_ADD_T_DURING_INSERT
 
+#ifdef RECONSTRUCTOR_TRILINEAR_KERNEL
+#ifdef RECONSTRUCTOR_ADD_T_DURING_INSERT
+#define RECONSTRUCTOR_INSERT_SLAB
+//#define RECONSTRUCTOR_INSERT_PRIVATE
+#endif
+#endif
+
 //#define RECONSTRUCTOR_CHECK_C_AVERAGE
 
 #define RECONSTRUCTOR_CHECK_C_MAX
@@ -116,6 +133,8 @@
 
 #define RECONSTRUCTOR_NORMALISE_T_F
 
+#define RECONSTRUCTOR_ALLREDUCE_SHELL
+
 //#define RECONSTRUCTOR_ALWAYS_JOIN_HALF
 
 //#define RECONSTRUCTOR_LOW_PASS
@@ -142,8 +161,27 @@
 
 //#define MODEL_DETERMINE_INCREASE_FSC
 
+#ifdef PARALLEL_NODE_AWARE
+#define MODEL_SHARED_PROJECTEE
+#endif
+
+#define MODEL_DISTRIBUTED_COMPARE
+
 #define OPTIMISER_CTF_ON_THE_FLY
 
+#define OPTIMISER_GLOBAL_SCAN_BLOCK
+
+#ifdef OPTIMISER_GLOBAL_SCAN_BLOCK
+#define OPTIMISER_GLOBAL_SCAN_MERGE_ROTATION
+#endif
+
+#define OPTIMISER_GLOBAL_SCAN_BATCH_PROJECT
+
+#if defined(OPTIMISER_GLOBAL_SCAN_BLOCK) && !defined(GPU_VERSION)
+#define OPTIMISER_CTF_DEDUP
+#define OPTIMISER_SIGMA_BY_GROUP
+#endif
+
 #define OPTIMISER_LOG_MEM_USAGE
 
 #define OPTIMISER_PARTICLE_FILTER
@@ -164,6 +202,16 @@
 
 #define OPTIMISER_RECENTRE_IMAGE_EACH_ITERATION
 
+#define OPTIMISER_READ_IMAGE_STACK
+
+#define OPTIMISER_IMG_SLAB
+
+#ifdef FFT_PLAN_CACHE
+#define OPTIMISER_FFT_BATCH
+#endif
+
+#define OPTIMISER_INSERT_BATCH
+
 //#define OPTIMISER_RECONSTRUCT_SIGMA_REGULARISE
 
 //#define OPTIMISER_SIGMA_MASK
@@ -233,6 +281,10 @@
 
 //#define OPTIMISER_SAVE_PARTICLES
 
+#define OPTIMISER_SAVE_DATABASE_PARALLEL
+
+//#define OPTIMISER_SAVE_DATABASE_BINARY
+
 //#define OPTIMISER_SAVE_BEST_PROJECTIONS
 
 //#define OPTIMISER_SAVE_SIGMA
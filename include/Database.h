@@ -93,9 +93,22 @@
 #define THU_SCORE 26
 #define THU_SCORE_FORMAT %12.6f
 
+#define THU_N_FIELD 27
+
+/**
+ * magic number at the head of a binary database (.thb) file
+ */
+#define THB_MAGIC "THUBIN01"
+
+/**
+ * number of particles converted from .thu to .thb at a time
+ */
+#define THB_CONVERT_CHUNK 65536
+
 #include <cstring>
 #include <cstdio>
 #include <iostream>
+#include <stdint.h>
 
 #include "Typedef.h"
 #include "Macro.h"
@@ -122,6 +135,54 @@ struct CTFAttr
     RFLOAT phaseShift;
 };
 
+/**
+ * header of a binary database (.thb) file
+ *
+ * A binary database holds the same fields as a .thu file, column by column.
+ * Each THU_* field is a fixed-width column of nParticle entries, double for
+ * numbers, int32_t for group and class ID and uint64_t offset into the
+ * string table for paths. Each column is padded to 8 bytes. The string table
+ * of NUL-terminated paths follows the last column.
+ */
+struct THBHeader
+{
+    char magic[8];
+
+    uint64_t nParticle;
+
+    int32_t nGroup;
+
+    int32_t nField;
+
+    /**
+     * offset in file of each column
+     */
+    uint64_t column[THU_N_FIELD];
+
+    /**
+     * offset in file of the string table
+     */
+    uint64_t strTable;
+
+    /**
+     * size of the string table
+     */
+    uint64_t strSize;
+};
+
+/**
+ * a particle (a line of .thu file), field[THU_PARTICLE_PATH] and
+ * field[THU_MICROGRAPH_PATH] are not used
+ */
+struct THURecord
+{
+    double field[THU_N_FIELD];
+
+    string path;
+
+    string micrographPath;
+};
+
 class Database : public Parallel
 {
     private:
@@ -148,6 +209,18 @@ class Database : public Parallel
          */
         vector<int> _reg;
 
+        /**
+         * whether the database is a binary one (.thb)
+         */
+        bool _binary;
+
+        /**
+         * the memory-mapped binary database
+         */
+        char* _map;
+
+        size_t _mapSize;
+
     public:
 
         Database();
@@ -166,6 +239,29 @@ class Database : public Parallel
          */
         void saveDatabase(const char database[]);
 
+        /**
+         * save particles of each process into a binary database (.thb), the
+         * particles are placed in the order of rank in comm, collective
+         * among comm
+         */
+        static void saveDatabaseBinary(const char database[],
+                                       const vector<THURecord>& records,
+                                       MPI_Comm comm);
+
+        /**
+         * convert a .thu file into a binary database (.thb)
+         */
+        static void convertDatabase(const char src[],
+                                    const char dst[]);
+
+        /**
+         * parse a line of .thu file, the line is modified
+         */
+        static void parseLine(THURecord& dst,
+                              char* line);
+
+        bool binary() const { return _binary; };
+
         int start() const { return _start; };
 
         int end() const { return _end; };
@@ -197,6 +293,17 @@ class Database : public Parallel
 
         void shuffle();
 
+        /**
+         * restore the register of each particle saved before, e.g. in a
+         * checkpoint, instead of shuffling, only the one of master is used
+         */
+        void shuffle(const vector<int>& reg);
+
+        /**
+         * the register of each particle
+         */
+        const vector<int>& reg() const;
+
         long offset(const int i) const;
 
         RFLOAT coordX(const int i) const;
@@ -248,6 +355,64 @@ class Database : public Parallel
         void split(int& start,
                    int& end,
                    int commRank);
+
+        const THBHeader& header() const
+        {
+            return *reinterpret_cast<const THBHeader*>(_map);
+        };
+
+        /**
+         * numeric field of the i-th particle in binary database
+         */
+        double field(const int f,
+                     const int i) const
+        {
+            return reinterpret_cast<const double*>(_map + header().column[f])[_reg[i]];
+        };
+
+        /**
+         * group or class ID of the i-th particle in binary database
+         */
+        int fieldInt(const int f,
+                     const int i) const
+        {
+            return reinterpret_cast<const int32_t*>(_map + header().column[f])[_reg[i]];
+        };
+
+        /**
+         * path of the i-th particle in binary database
+         */
+        const char* fieldStr(const int f,
+                             const int i) const
+        {
+            return _map
+                 + header().strTable
+                 + reinterpret_cast<const uint64_t*>(_map + header().column[f])[_reg[i]];
+        };
+
+        /**
+         * width of a column in binary database
+         */
+        static size_t widthBinary(const int f);
+
+        /**
+         * determine the layout of a binary database
+         */
+        static void initHeaderBinary(THBHeader& header,
+                                     const size_t nParticle,
+                                     const int nGroup,
+                                     const size_t strSize);
+
+        /**
+         * write n records into an opened binary database, starting from the
+         * iBegin-th particle and the strBegin-th byte of the string table
+         */
+        static void writeBinary(const int fd,
+                                const THBHeader& header,
+                                const THURecord* records,
+                                const size_t n,
+                                const size_t iBegin,
+                                const size_t strBegin);
 };
 
 #endif // DATABASE_H
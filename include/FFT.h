@@ -221,6 +221,21 @@
         fft.bw(dst); \
     } while (0)
 
+/**
+ * the planner flag used when a plan is created for the plan cache
+ */
+#define FFT_PLAN_FLAG FFTW_MEASURE
+
+/**
+ * the number of images transformed by a single plan in fwBatch and bwBatch
+ */
+#define FFT_BATCH_SIZE 16
+
+/**
+ * the name of the file storing FFTW wisdom, placed in the output directory
+ */
+#define FFT_WISDOM_FILE "FFTW_Wisdom.dat"
+
 class FFT
 {
     private:
@@ -363,6 +378,34 @@ class FFT
          * @brief This function destroys the created plan that performs inverse Fourier transform on an image or volume.
          */
         void bwDestroyPlan();
+
+#ifdef FFT_PLAN_CACHE
+        /**
+         * @brief This function performs Fourier transform on a batch of images of the same size. Each thread copies FFT_BATCH_SIZE images into a contiguous slab and transforms them with one plan, so that the parallelism lies across the batch. The real space of the images is cleared.
+         */
+        static void fwBatch(Image* const* img,          /**< [in] the images to be transformed */
+                            const int n,                /**< [in] the number of images */
+                            const unsigned int nThread  /**< [in] the number of threads to be used */
+                            );
+
+        /**
+         * @brief This function performs inverse Fourier transform on a batch of images of the same size, in the same way as fwBatch. The Fourier space of the images is cleared.
+         */
+        static void bwBatch(Image* const* img,          /**< [in] the images to be transformed */
+                            const int n,                /**< [in] the number of images */
+                            const unsigned int nThread  /**< [in] the number of threads to be used */
+                            );
+#endif
+
+        /**
+         * @brief This function imports FFTW wisdom accumulated by previous runs, it returns whether the wisdom is imported.
+         */
+        static bool importWisdom(const char* filename /**< [in] the file storing wisdom */);
+
+        /**
+         * @brief This function exports FFTW wisdom accumulated in planning, it returns whether the wisdom is exported.
+         */
+        static bool exportWisdom(const char* filename /**< [in] the file storing wisdom */);
 };
 
 #endif // FFT_H 
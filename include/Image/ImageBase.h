@@ -229,6 +229,14 @@ class ImageBase
         RFLOAT* _dataRL;
 
         Complex* _dataFT;
+
+        /**
+         * memory in Fourier space owned by others (e.g. an ImageSlab), it is
+         * not freed, and it is re-used when Fourier space is allocated again
+         */
+        Complex* _slabFT;
+
+        size_t _slabSizeFT;
 #endif
 
         size_t _sizeRL;
@@ -246,13 +254,22 @@ class ImageBase
             that._sizeFT = 0;
 
 #ifdef FFTW_PTR
+            _slabFT = that._slabFT;
+            _slabSizeFT = that._slabSizeFT;
+
             that._dataRL = NULL;
             that._dataFT = NULL;
+            that._slabFT = NULL;
 #endif
         }
 
         ~ImageBase();
 
+        /**
+         * free the memory in Fourier space if it is not owned by others
+         */
+        void freeFT();
+
     public:
 
         void swap(ImageBase& that);
@@ -357,6 +374,25 @@ class ImageBase
 
         void copyBase(ImageBase&) const;
 
+        /**
+         * move the Fourier space into a block of memory of sizeFT() elements
+         * owned by others, which is kept when Fourier space is cleared and
+         * re-allocated
+         */
+        void attachFT(Complex* block);
+
+        /**
+         * check whether Fourier space is attached to the given block of memory
+         */
+        bool isAttachedFT(const Complex* block) const;
+
+        /**
+         * use a block of sizeFT() elements owned by others as Fourier space
+         * without copying into it, e.g. memory filled and shared by another
+         * process, which is then only read
+         */
+        void mapFT(Complex* block);
+
         ImageBase copyBase() const;
 };
 
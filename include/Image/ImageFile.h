@@ -100,6 +100,14 @@ class ImageFile
 
         MRCHeader _MRCHeader;
 
+        /**
+         * the whole file mapped read-only into memory, NULL if the file is
+         * accessed by stdio
+         */
+        char* _map;
+
+        size_t _mapSize;
+
     public:
 
         ImageFile();
@@ -137,6 +145,21 @@ class ImageFile
                        const int iSlc = 0,
                        const char* fileType = "MRC");
 
+        /**
+         * read a group of slices of a MRC stack, slices with adjacent indices
+         * are read in by a single fread
+         * iSlc should be sorted in ascending order
+         */
+        void readImages(Image* const* dst,
+                        const int* iSlc,
+                        const int n);
+
+        /**
+         * read-only view of the raw data of a slice in a memory-mapped MRC
+         * file, NULL if the file is not memory-mapped
+         */
+        const void* slice(const int iSlc) const;
+
         void readVolume(Volume& dst,
                         const char* fileType = "MRC");
 
@@ -162,6 +185,11 @@ class ImageFile
 
     private:
 
+        void mapFile();
+
+        const char* mapData(const size_t offset,
+                            const size_t size) const;
+
         void readMetaDataMRC();
 
         void fillMRCHeader(MRCHeader& header) const;        
@@ -185,6 +213,11 @@ class ImageFile
 };
 
 
+/**
+ * maximum number of bytes read in by a single fread in readImages
+ */
+#define IMAGE_FILE_MAX_READ_SIZE (64 * 1024 * 1024)
+
 #define SKIP_HEAD(i) \
     if (fseek(_file, 1024 + symmetryDataSize() + i, 0) != 0) \
         REPORT_ERROR("Fail to read in an image.");
@@ -226,6 +259,35 @@ class ImageFile
 */
 
 
+/**
+ * convert a contiguous row of raw MRC data, widening integer modes with SIMD
+ */
+void CAST_ROW(RFLOAT* dst, const char* src, const size_t n);
+void CAST_ROW(RFLOAT* dst, const unsigned char* src, const size_t n);
+void CAST_ROW(RFLOAT* dst, const short* src, const size_t n);
+void CAST_ROW(RFLOAT* dst, const float* src, const size_t n);
+
+/**
+ * the half-shift of MESH_IMAGE_INDEX turns every row into two contiguous
+ * pieces, which are converted by CAST_ROW
+ */
+template <typename T> inline void  IMAGE_CAST
+                      (const T * unCast, 
+                       Image  &dst )
+{ 
+        int nCol = dst.nColRL();
+        int nRow = dst.nRowRL();
+
+        for (int j = 0; j < nRow; j++) 
+        {
+            const T* src = unCast + (size_t)((j + nRow / 2) % nRow) * nCol;
+            RFLOAT* row = &dst(IMAGE_INDEX(0, (size_t)j, nCol));
+
+            CAST_ROW(row, src + nCol / 2, nCol - nCol / 2);
+            CAST_ROW(row + nCol - nCol / 2, src, nCol / 2);
+        }
+}
+
 template <typename T> inline void  IMAGE_READ_CAST
                       (FILE * imFile, 
                        Image  &dst )
@@ -233,13 +295,7 @@ template <typename T> inline void  IMAGE_READ_CAST
         T * unCast = new T[dst.sizeRL()]; 
         if (fread(unCast, sizeof(T), dst.sizeRL()  ,imFile) == 0) 
             REPORT_ERROR("Fail to read in an image."); 
-        for (int j = 0; j < dst.nRowRL(); j++) 
-            for (int i = 0; i < dst.nColRL(); i++) 
-                dst(IMAGE_INDEX(i, j, dst.nColRL())) 
-              = (RFLOAT)unCast[MESH_IMAGE_INDEX(i, 
-                                                j, 
-                                                dst.nColRL(), 
-                                                dst.nRowRL())]; 
+        IMAGE_CAST<T>(unCast, dst);
         delete[] unCast; 
 }
 
@@ -265,6 +321,28 @@ template <typename T> inline void  IMAGE_READ_CAST
 
 */
 
+template <typename T> inline void  VOLUME_CAST 
+                                  ( const T *unCast, 
+                                    Volume &dst
+                                    ) 
+{ 
+        int nCol = dst.nColRL();
+        int nRow = dst.nRowRL();
+        int nSlc = dst.nSlcRL();
+
+        for (int k = 0; k < nSlc; k++) 
+            for (int j = 0; j < nRow; j++) 
+            {
+                const T* src = unCast
+                             + ((size_t)((k + nSlc / 2) % nSlc) * nRow
+                              + (j + nRow / 2) % nRow) * nCol;
+                RFLOAT* row = &dst(VOLUME_INDEX(0, (size_t)j, (size_t)k, nCol, nRow));
+
+                CAST_ROW(row, src + nCol / 2, nCol - nCol / 2);
+                CAST_ROW(row + nCol - nCol / 2, src, nCol / 2);
+            }
+}
+
 template <typename T> inline void  VOLUME_READ_CAST 
                                   ( FILE *imFile, 
                                     Volume &dst
@@ -273,16 +351,7 @@ template <typename T> inline void  VOLUME_READ_CAST
         T* unCast = new T[dst.sizeRL() ]; 
         if (fread(unCast, sizeof(T), dst.sizeRL() , imFile) == 0) 
             REPORT_ERROR("Fail to read in an image."); 
-        for (int k = 0; k < dst.nSlcRL(); k++) 
-            for (int j = 0; j < dst.nRowRL(); j++) 
-                for (int i = 0; i < dst.nColRL(); i++) 
-                    dst(VOLUME_INDEX(i, j, k, dst.nColRL(), dst.nRowRL())) 
-                  = (RFLOAT)unCast[MESH_VOLUME_INDEX(i, 
-                                                     j, 
-                                                     k, 
-                                                     dst.nColRL(), 
-                                                     dst.nRowRL(), 
-                                                     dst.nSlcRL())];  
+        VOLUME_CAST<T>(unCast, dst);
         delete[] unCast; 
 }
 /*
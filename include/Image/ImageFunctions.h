@@ -389,15 +389,44 @@ void translate(Image& dst,
                const int nPxl,
                const unsigned int nThread);
 
-//void translate(Complex* dst,
-//               const RFLOAT nTransCol,
-//               const RFLOAT nTransRow,
-//               const int nCol,
-//               const int nRow,
-//               const int* iCol,
-//               const int* iRow,
-//               const int nPxl);
+#ifdef IMAGE_TRANSLATE_SEPARABLE
+/**
+ * This function generates the phases of translating nTrans pixels along a
+ * dimension of n pixels, from index -n / 2 to n / 2. As the phase of a pixel is
+ * the product of the phase of its column and the phase of its row, a
+ * "translation image" costs a complex multiplication per pixel rather than a
+ * pair of sine and cosine. It returns the phase of index 0, which stays valid
+ * until the calling thread generates the phases of the same dimension again.
+ *
+ * @param dim    0 for columns, 1 for rows
+ * @param nTrans number of pixels for translation
+ * @param n      number of pixels of the dimension
+ */
+const Complex* translatePhase(const int dim,
+                              const RFLOAT nTrans,
+                              const int n);
+#endif
+
+/**
+ * This function generates a "translation image" in the pre-determined pixel
+ * indices with a given vector indicating the number of columns and the number
+ * of rows by the calling thread. It never enters the OpenMP runtime, thus it
+ * is the one to be called in parallel regions.
+ */
+void translate(Complex* dst,
+               const RFLOAT nTransCol,
+               const RFLOAT nTransRow,
+               const int nCol,
+               const int nRow,
+               const int* iCol,
+               const int* iRow,
+               const int nPxl);
 
+/**
+ * This function generates a "translation image" in the pre-determined pixel
+ * indices with a given vector indicating the number of columns and the number
+ * of rows using multiple threads.
+ */
 void translate(Complex* dst,
                const RFLOAT nTransCol,
                const RFLOAT nTransRow,
@@ -520,16 +549,21 @@ void translate(Image& dst,
                const int nPxl,
                const unsigned int nThread);
 
-//void translate(Complex* dst,
-//               const Complex* src,
-//               const RFLOAT nTransCol,
-//               const RFLOAT nTransRow,
-//               const int nCol,
-//               const int nRow,
-//               const int* iCol,
-//               const int* iRow,
-//               const int nPxl);
-
+/**
+ * This function translates an image in the pre-determined pixel indices with a
+ * given vector indicating the number of columns and the number of rows by the
+ * calling thread. It never enters the OpenMP runtime, thus it is the one to be
+ * called in parallel regions.
+ */
+void translate(Complex* dst,
+               const Complex* src,
+               const RFLOAT nTransCol,
+               const RFLOAT nTransRow,
+               const int nCol,
+               const int nRow,
+               const int* iCol,
+               const int* iRow,
+               const int nPxl);
 
 void translate(Complex* dst,
                const Complex* src,
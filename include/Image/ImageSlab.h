@@ -0,0 +1,86 @@
+/*******************************************************************************
+ * Author: Mingxu Hu
+ * Dependency:
+ * Test:
+ * Execution:
+ * Description:
+ *
+ * Manual:
+ * ****************************************************************************/
+
+#ifndef IMAGE_SLAB_H
+#define IMAGE_SLAB_H
+
+#include "Config.h"
+#include "Macro.h"
+#include "Complex.h"
+#include "Precision.h"
+#include "Logging.h"
+
+#include "Image.h"
+
+/**
+ * alignment of each slot of the slab in bytes
+ */
+#define IMAGE_SLAB_ALIGN 64
+
+/**
+ * ImageSlab is one aligned block of memory holding Fourier space of a number of
+ * images of the same size, one slot per image. Images attached to a slot work
+ * as views into the slab. The memory is first touched by threads in the same
+ * static schedule as the loops over images, so that each slot is placed on the
+ * NUMA node of the thread processing it.
+ */
+class ImageSlab
+{
+    private:
+
+        Complex* _data;
+
+        size_t _nSlot;
+
+        /**
+         * number of elements of a slot, padded to IMAGE_SLAB_ALIGN
+         */
+        size_t _stride;
+
+        size_t _sizeFT;
+
+        ImageSlab(const ImageSlab&);
+
+        ImageSlab& operator=(const ImageSlab&);
+
+    public:
+
+        ImageSlab();
+
+        ~ImageSlab();
+
+        /**
+         * allocate nSlot slots, each of which stores sizeFT elements
+         */
+        void alloc(const size_t nSlot,
+                   const size_t sizeFT);
+
+        void clear();
+
+        size_t nSlot() const { return _nSlot; };
+
+        size_t sizeFT() const { return _sizeFT; };
+
+        size_t stride() const { return _stride; };
+
+        inline Complex* slot(const size_t i) const
+        {
+            return _data + i * _stride;
+        };
+
+        /**
+         * attach images to slots from the iSlot-th one on, images already
+         * attached to their slots are skipped
+         */
+        void attach(vector<Image>& img,
+                    const size_t iSlot);
+};
+
+#endif // IMAGE_SLAB_H
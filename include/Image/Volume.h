@@ -260,6 +260,15 @@ class Volume : public ImageBase
                    const int space /**< [in] the space this volume allocating, where RL_SPACE stands for the real space and FT_SPACE stands for the Fourier space */
                   );
 
+        /**
+         * @brief Map Fourier space of a volume in designated size onto a block of memory owned by others without allocating, e.g. memory shared among processes, which is only read.
+         */
+        void mapFT(Complex* block, /**< [in] the block of (nCol / 2 + 1) * nRow * nSlc elements */
+                   const int nCol, /**< [in] number of columns of this volume */
+                   const int nRow, /**< [in] number of rows of this volume */
+                   const int nSlc  /**< [in] number of slices of this volume */
+                  );
+
         /**
          * @brief Return the number of columns of this volume in real space.
          *
@@ -25,6 +25,8 @@
 #include "Symmetry.h"
 #include "Reconstructor.h"
 #include "Particle.h"
+#include "Checkpoint.h"
+#include "Profiler.h"
 
 #include <boost/container/vector.hpp>
 #include <boost/move/make_unique.hpp>
@@ -556,6 +558,24 @@ class Model : public Parallel
                                    const RFLOAT thres,
                                    const unsigned int nThread);
 
+#ifdef MODEL_DISTRIBUTED_COMPARE
+
+        /**
+         * This function compares the references from two hemispheres without
+         * gathering them in the master. Slices of each reference are
+         * partitioned among pairs of processes, one from each hemisphere, which
+         * exchange their slices, sum the shells of FSC partially and average
+         * their slices in place. The sums are all reduced to FSC, and each
+         * hemisphere gathers the averaged slices. Exchanges of the next
+         * reference overlap the computing of the current one.
+         */
+        void compareTwoHemispheresDistributed(const bool fscFlag,
+                                              const bool avgFlag,
+                                              const RFLOAT thres,
+                                              const unsigned int nThread);
+
+#endif
+
         /**
          * This function performs a low pass filter on each reference.
          * 
@@ -669,12 +689,37 @@ class Model : public Parallel
          */
         void setProjMaxRadius(const int maxRadius);
 
+        /**
+         * This function puts the state of the model into a checkpoint,
+         * including frequencies, variances, counters, FSC, SNR, tau and sigma.
+         * The references are put as well if ref is set.
+         */
+        void saveCheckpoint(Checkpoint& cp,
+                            const bool ref) const;
+
+        /**
+         * This function gets the state of the model from a checkpoint. The
+         * references are got if they were put.
+         */
+        void loadCheckpoint(Checkpoint& cp);
+
         /**
          * This function refreshs the projectors by resetting the projectee, the
          * frequency threshold and padding factor, respectively.
          */
         void refreshProj(const unsigned int nThread);
 
+#ifdef MODEL_SHARED_PROJECTEE
+
+        /**
+         * This function refreshs the projectors in 3D mode, where the padded
+         * projectees are set by the first process of each node and hemisphere
+         * in the shared memory of the node, and mapped by the others.
+         */
+        void refreshProjShared(const unsigned int nThread);
+
+#endif
+
         /**
          * This function refreshs the reconstructors by resetting the size,
          * padding factor, symmetry information, MKB kernel parameters,
@@ -16,7 +16,9 @@
 #include <string>
 #include <climits>
 #include <queue>
+#include <map>
 #include <functional>
+#include <algorithm>
 
 #include <gsl/gsl_sort.h>
 #include <gsl/gsl_statistics.h>
@@ -32,6 +34,7 @@
 #include "Image.h"
 #include "Volume.h"
 #include "ImageFile.h"
+#include "ImageSlab.h"
 #include "Spectrum.h"
 #include "Symmetry.h"
 #include "CTF.h"
@@ -39,6 +42,8 @@
 #include "Particle.h"
 #include "Database.h"
 #include "Model.h"
+#include "Checkpoint.h"
+#include "Profiler.h"
 
 #ifdef GPU_VERSION
 #include "Interface.h"
@@ -46,6 +51,11 @@
 
 #define FOR_EACH_2D_IMAGE for (ptrdiff_t l = 0; l < static_cast<ptrdiff_t>(_ID.size()); l++)
 
+/**
+ * number of images inserted between two flushes of the buffered insertion
+ */
+#define OPTIMISER_INSERT_BLOCK 256
+
 #define R_GLOBAL_FACTOR 0.25
 
 #define MIN_M_S 1500
@@ -53,6 +63,17 @@
 #define ALPHA_GLOBAL_SEARCH 1.0
 #define ALPHA_LOCAL_SEARCH 0
 
+/**
+ * number of images scanned together in a block during global search, the
+ * accumulators of a block against all translations should fit in L1
+ */
+#define GLOBAL_SCAN_BLOCK_IMG 64
+
+/**
+ * number of rotations projected together in a batch during global search
+ */
+#define GLOBAL_SCAN_BATCH_ROT 8
+
 #define MIN_N_PHASE_PER_ITER_GLOBAL 10
 #define MIN_N_PHASE_PER_ITER_LOCAL 3
 #define MAX_N_PHASE_PER_ITER 100
@@ -408,6 +429,34 @@ struct OptimiserPara
 
     bool saveTHUEachIter;
 
+#define KEY_CHECKPOINT_EACH "Save Checkpoint Every N Rounds"
+
+    /**
+     * save a checkpoint every this number of rounds, never if it is 0
+     */
+    int checkpointEach;
+
+    /**
+     * resume from the checkpoint instead of initialising, set by --resume in
+     * command line
+     */
+    bool resume;
+
+#define KEY_PROFILE "Profile Phases"
+
+    /**
+     * time phases and kernels, and report them each round
+     */
+    bool profile;
+
+#define KEY_PROFILE_TRACE "Save Trace of Phases"
+
+    /**
+     * save the timeline of phases and kernels in the format of Chrome tracing
+     * each round, only if profile is set
+     */
+    bool profileTrace;
+
 #define KEY_SUBTRACT "Subtract Masked Region Reference From Images"
 
     bool subtract;
@@ -446,6 +495,10 @@ struct OptimiserPara
         skipR = false;
         saveRefEachIter = true;
         saveTHUEachIter = true;
+        checkpointEach = 0;
+        resume = false;
+        profile = false;
+        profileTrace = false;
         subtract = false;
     }
 };
@@ -535,6 +588,14 @@ class Optimiser : public Parallel
          */
         vector<int> _ID;
 
+#ifdef OPTIMISER_IMG_SLAB
+        /**
+         * Fourier space of 2D images, unmasked 2D images and CTFs of this
+         * process, stored contiguously in one block
+         */
+        ImageSlab _imgSlab;
+#endif
+
         /**
          * 2D images
          */
@@ -670,17 +731,58 @@ class Optimiser : public Parallel
 
         Complex* _datP;
 
+        /**
+         * CTF of each image, or under OPTIMISER_CTF_DEDUP, one row for each
+         * distinct CTFAttr
+         */
         RFLOAT* _ctfP;
 
+        /**
+         * number of rows of _ctfP
+         */
+        int _nCTF;
+
+        /**
+         * row of _ctfP holding the CTF of each image
+         */
+        int* _ctfIdx;
+
+        /**
+         * sigma of each image, or under OPTIMISER_SIGMA_BY_GROUP, one row for
+         * each group held by this process
+         */
         RFLOAT* _sigP;
 
+        /**
+         * reciprocal of sigma, in the same layout as _sigP
+         */
         RFLOAT* _sigRcpP;
 
+        /**
+         * number of rows of _sigP and _sigRcpP
+         */
+        int _nSig;
+
+        /**
+         * row of _sigP and _sigRcpP of each image
+         */
+        int* _sigIdx;
+
         /**
          * spatial frequency of each pixel
          */
         RFLOAT* _frequency;
 
+        /**
+         * cos(2 * angle) of each pixel
+         */
+        RFLOAT* _cos2Angle;
+
+        /**
+         * sin(2 * angle) of each pixel
+         */
+        RFLOAT* _sin2Angle;
+
         /**
          * defocus of each pixel of each image
          */
@@ -725,7 +827,12 @@ class Optimiser : public Parallel
 
             _datP = NULL;
             _ctfP = NULL;
+            _nCTF = 0;
+            _ctfIdx = NULL;
+            _sigP = NULL;
             _sigRcpP = NULL;
+            _nSig = 0;
+            _sigIdx = NULL;
         }
 
 #ifdef GPU_VERSION
@@ -836,6 +943,12 @@ class Optimiser : public Parallel
          */
         void bwImg();
 
+        /**
+         * move Fourier space of images, original images and CTFs into the
+         * image slab
+         */
+        void attachImgSlab();
+
         /**
          * initialise CTFs
          */
@@ -951,9 +1064,38 @@ class Optimiser : public Parallel
 
         void freePreCal(const bool ctf);
 
+        /**
+         * CTF of the l-th image in an image-major _ctfP
+         */
+        RFLOAT* ctfRowP(const int l) const;
+
+        /**
+         * reciprocal of sigma of the l-th image in an image-major _sigRcpP
+         */
+        RFLOAT* sigRcpRowP(const int l) const;
+
         void saveDatabase(const bool finished = false,
                           const bool subtract = false) const;
 
+        /**
+         * save the states of all processes needed for resuming from the next
+         * round into one checkpoint file
+         */
+        void saveCheckpoint() const;
+
+        /**
+         * read the checkpoint of this process, restore the round, the search
+         * type and the order of particles in database
+         */
+        void openCheckpoint(Checkpoint& cp);
+
+        /**
+         * restore the states of the model, sigma, intensity scales and
+         * particle filters from the checkpoint, and re-centre and re-mask
+         * images accordingly
+         */
+        void loadCheckpoint(Checkpoint& cp);
+
         void saveSubtract();
 
         /**
@@ -1152,6 +1294,26 @@ vec logDataVSPrior(const Complex* dat,
                    const int n,
                    const int m);
 
+/**
+ * These functions are the kernels of logDataVSPrior in expectation. The _m_n_
+ * ones compare a certain projection with n images of m pixels stored one after
+ * another and write n results into result. The _m_ ones compare a projection
+ * with an image. The scalar ones are always built, the SIMD256 and SIMD512
+ * ones only when AVX and AVX-512 are enabled.
+ */
+RFLOAT logDataVSPrior_m_huabin(const Complex* dat, const Complex* pri, const RFLOAT* ctf, const RFLOAT* sigRcp, const int m);
+RFLOAT* logDataVSPrior_m_n_huabin(const Complex* dat, const Complex* pri, const RFLOAT* ctf, const RFLOAT* sigRcp, const int n, const int m, RFLOAT *result);
+
+#ifdef ENABLE_SIMD_256
+RFLOAT* logDataVSPrior_m_n_huabin_SIMD256(Complex* dat, const Complex* pri, const RFLOAT* ctf, const RFLOAT* sigRcp, const int n, const int m, RFLOAT *SIMDResult);
+RFLOAT logDataVSPrior_m_huabin_SIMD256(Complex* dat, const Complex* pri, const RFLOAT* ctf, const RFLOAT* sigRcp, const int m);
+#endif
+
+#ifdef ENABLE_SIMD_512
+RFLOAT* logDataVSPrior_m_n_huabin_SIMD512(Complex* dat, const Complex* pri, const RFLOAT* ctf, const RFLOAT* sigRcp, const int n, const int m, RFLOAT *SIMDResult);
+RFLOAT logDataVSPrior_m_huabin_SIMD512(Complex* dat, const Complex* pri, const RFLOAT* ctf, const RFLOAT* sigRcp, const int m);
+#endif
+
 RFLOAT dataVSPrior(const Image& dat,
                    const Image& pri,
                    const Image& ctf,
@@ -26,6 +26,7 @@
 
 #include <cstdio>
 #include <mpi.h>
+#include "Config.h"
 #include "Logging.h"
 #include "Precision.h"
 #include <boost/noncopyable.hpp>
@@ -35,6 +36,11 @@
  */
 #define MPI_MAX_BUF 2000000000
 
+/**
+ * @brief the size in bytes of the shared memory slot of each process in node-aware collectives, large buffers are reduced or broadcasted in chunks of this size
+ */
+#define MPI_NODE_CHUNK (16 * 1024 * 1024)
+
 /**
  * @brief process ID of master process
  */
@@ -246,7 +252,7 @@ void MPI_Ssend_Large(const void *buf,       /**< [in] the data elements to be se
                     );
 
 /**
- * @brief  This function can be used for broadcasting large size(>2GB) data
+ * @brief  This function can be used for broadcasting large size(>2GB) data. With PARALLEL_NODE_AWARE, the data crosses each node once: it is broadcasted among leaders of nodes and then copied from shared memory by processes of each node, chunk by chunk without barriers of the whole communicator.
  */
 void MPI_Bcast_Large(void *buf,             /**< [in] the data elements used for broadcasting. */
                      size_t count,          /**< [in] the number of data elements to be broadcasted. */
@@ -255,7 +261,7 @@ void MPI_Bcast_Large(void *buf,             /**< [in] the data elements used for
                      MPI_Comm comm          /**< [in] the communicator that the sending/receiving processes belongs to. */
                      );
 /**
- * @brief This function is used for all reducing operation for large size(>2GB) data
+ * @brief This function is used for all reducing operation for large size(>2GB) data. With PARALLEL_NODE_AWARE, sums of float, double and their complex types are first reduced within each node through shared memory, then all reduced among leaders of nodes, chunk by chunk without barriers of the whole communicator.
  *
  * @param buf      the buffer area of all-reducing data
  * @param count    the number of the data
@@ -270,4 +276,38 @@ void MPI_Allreduce_Large(void *buf,             /**< [in] the data buffer used f
                          MPI_Comm comm        /**< [in] the communicator that the all reducing processes belongs to. */
                         );
 
+#ifdef PARALLEL_NODE_AWARE
+
+/**
+ * @brief This function gets the node communicator, which holds the processes of the communicator running on the same node as the current process, and the leader communicator, which holds the first process of each node, MPI_COMM_NULL on other processes. The result is split once and cached as an attribute of the communicator.
+ */
+void MPI_Comm_Split_Node(MPI_Comm comm,    /**< [in]  the communicator to be split. */
+                         MPI_Comm* node,   /**< [out] the communicator of processes on the same node. */
+                         MPI_Comm* leader  /**< [out] the communicator of leaders of nodes. */
+                        );
+
+/**
+ * @brief This function returns a block of at least size bytes in the shared memory of the node, which is held by the first process of the node and mapped by the other processes of the communicator on the same node. It is collective over the communicator, and all processes must ask for the same size. There is one block per communicator, which is re-allocated only when a larger size is asked for, and freed in MPI_Finalize.
+ */
+char* MPI_Alloc_Shared_Node(MPI_Comm comm, /**< [in] the communicator whose processes share the block. */
+                            size_t size    /**< [in] the size of the block in bytes. */
+                           );
+
+/**
+ * @brief This function makes writes to the block of MPI_Alloc_Shared_Node visible to all processes of the node, and waits for all of them, thus no process reads the block while it is being written.
+ */
+void MPI_Sync_Shared_Node(MPI_Comm comm /**< [in] the communicator whose processes share the block. */
+                         );
+
+#endif
+
+/**
+ * @brief This function writes the buffers of all processes in the communicator into one file, one after another in the order of rank. Each process computes its offset in file by an exclusive scan and writes its buffer concurrently. The file is truncated to the total size first.
+ */
+void MPI_Write_Ordered_Large(const char* filename, /**< [in] the file to be written. */
+                             const void* buf,      /**< [in] the data buffer of the current process. */
+                             size_t size,          /**< [in] the size of the data buffer in bytes. */
+                             MPI_Comm comm         /**< [in] the communicator that the writing processes belongs to. */
+                            );
+
 #endif // PARALLEL_H
@@ -29,6 +29,7 @@
 #include "Functions.h"
 #include "Symmetry.h"
 #include "DirectionalStat.h"
+#include "Checkpoint.h"
 
 #define FOR_EACH_C(par) for (int iC = 0; iC < par.nC(); iC++)
 #define FOR_EACH_R(par) for (int iR = 0; iR < par.nR(); iR++)
@@ -569,6 +570,18 @@ class Particle
                   const double s,
                   const double score);
 
+        /**
+         * This function puts the whole state of this particle filter into a
+         * checkpoint, except the symmetry.
+         */
+        void saveCheckpoint(Checkpoint& cp) const;
+
+        /**
+         * This function gets the whole state of this particle filter from a
+         * checkpoint, except the symmetry.
+         */
+        void loadCheckpoint(Checkpoint& cp);
+
         /**
          * This function returns the concentration parameters, including
          * rotation and translation.
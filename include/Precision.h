@@ -529,6 +529,32 @@ TSFFTW_PLAN TSFFTW_plan_dft_c2r_3d(int n0,             /**< [in] length of first
                                    unsigned flags      /**< [in] flags used for control transformation. */
                                   );
 
+/**
+ *  @brief Create a fftw plan used for transformation of a batch of arrays, stored one after another, from real space to fourier space.
+ */
+TSFFTW_PLAN TSFFTW_plan_many_dft_r2c(int rank,            /**< [in] the number of dimensions. */
+                                     const int *n,        /**< [in] length of each dimension. */
+                                     int howmany,         /**< [in] the number of arrays in the batch. */
+                                     RFLOAT *in,          /**< [in] data elements in real space. */
+                                     int idist,           /**< [in] distance between two successive arrays in real space. */
+                                     TSFFTW_COMPLEX *out, /**< [out] data elements in fourier space. */
+                                     int odist,           /**< [in] distance between two successive arrays in fourier space. */
+                                     unsigned flags       /**< [in] flags used for control transformation. */
+                                    );
+
+/**
+ *  @brief Create a fftw plan used for transformation of a batch of arrays, stored one after another, from fourier space to real space.
+ */
+TSFFTW_PLAN TSFFTW_plan_many_dft_c2r(int rank,            /**< [in] the number of dimensions. */
+                                     const int *n,        /**< [in] length of each dimension. */
+                                     int howmany,         /**< [in] the number of arrays in the batch. */
+                                     TSFFTW_COMPLEX *in,  /**< [in] data elements in fourier space. */
+                                     int idist,           /**< [in] distance between two successive arrays in fourier space. */
+                                     RFLOAT *out,         /**< [out] data elements in real space. */
+                                     int odist,           /**< [in] distance between two successive arrays in real space. */
+                                     unsigned flags       /**< [in] flags used for control transformation. */
+                                    );
+
 /**
  *  @brief Initialized thread number used for planner routines.
  */
@@ -539,4 +565,25 @@ void TSFFTW_plan_with_nthreads(int nthreads /**< [in] thread number used for pla
  */
 void TSFFTW_set_timelimit(RFLOAT seconds /**< [in] max seconds to spend. */);
 
+/**
+ *  @brief Get the alignment of an array, plans of FFTW are only valid for arrays with the same alignment as the arrays used in planning.
+ *
+ *  @return the alignment of the array in bytes.
+ */
+int TSFFTW_alignment_of(RFLOAT *p /**< [in] the array to be checked. */);
+
+/**
+ *  @brief Import FFTW wisdom from a file.
+ *
+ *  @return non-zero if wisdom is imported successfully.
+ */
+int TSFFTW_import_wisdom_from_filename(const char *filename /**< [in] the file storing wisdom. */);
+
+/**
+ *  @brief Export accumulated FFTW wisdom to a file.
+ *
+ *  @return non-zero if wisdom is exported successfully.
+ */
+int TSFFTW_export_wisdom_to_filename(const char *filename /**< [in] the file storing wisdom. */);
+
 #endif // PRECISION_H
@@ -0,0 +1,146 @@
+/*******************************************************************************
+ * Author: Mingxu Hu
+ * Dependency:
+ * Test:
+ * Execution:
+ * Description:
+ *
+ * Manual:
+ * ****************************************************************************/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <ctime>
+#include <mpi.h>
+
+#include "Config.h"
+#include "Macro.h"
+#include "Logging.h"
+
+/**
+ * maximum number of trace events kept by a thread in a round, scopes beyond it
+ * are only aggregated
+ */
+#define PROFILER_MAX_TRACE_EVENTS (1 << 16)
+
+/**
+ * Profiler times nested scopes of each thread. Scopes of the same name under
+ * the same parent scope are aggregated into one node, whose path joins the
+ * names from the root by "/". A scope entered by a worker thread of OpenMP
+ * with no scope open is hung under the innermost scope of the main thread,
+ * thus kernels called in parallel regions are aggregated under the phase
+ * calling them.
+ *
+ * Profiler is switched on at runtime, a scope costs a branch when it is off.
+ */
+class Profiler
+{
+    private:
+
+        static bool _enabled;
+
+        static bool _trace;
+
+        /**
+         * the time when the profiler is enabled, the origin of trace events
+         */
+        static double _origin;
+
+    public:
+
+        /**
+         * enable profiling on all processes of the communicator, save trace
+         * events as well if trace is set
+         */
+        static void enable(const bool trace,
+                           MPI_Comm comm);
+
+        static inline bool enabled() { return _enabled; };
+
+        /**
+         * the monotonic time in seconds, safe to be called by any thread
+         */
+        static inline double time()
+        {
+            timespec ts;
+
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+
+            return ts.tv_sec + 1e-9 * ts.tv_nsec;
+        };
+
+        /**
+         * open a scope of the calling thread, return its node
+         */
+        static int enter(const char* name);
+
+        /**
+         * close the innermost scope of the calling thread, which is opened at
+         * start
+         */
+        static void leave(const int node,
+                          const double start);
+
+        /**
+         * Report the scopes closed since the last report, and reset them. The
+         * aggregates of each thread of each process are written into
+         * [prefix]Profile_Round_[iter].txt, the minimum, mean and maximum among
+         * processes are logged by master, and trace events are written into
+         * [prefix]Trace_Round_[iter].json in the format of Chrome tracing. It
+         * shall be called by all processes of the communicator with no scope
+         * open.
+         */
+        static void report(const int iter,
+                           const char* prefix,
+                           MPI_Comm comm);
+};
+
+/**
+ * ProfileScope opens a scope of Profiler in its life time.
+ */
+class ProfileScope
+{
+    private:
+
+        int _node;
+
+        double _start;
+
+    public:
+
+        explicit ProfileScope(const char* name)
+        {
+            if (Profiler::enabled())
+            {
+                _node = Profiler::enter(name);
+                _start = Profiler::time();
+            }
+            else
+                _node = -1;
+        }
+
+        ~ProfileScope()
+        {
+            if (_node != -1) Profiler::leave(_node, _start);
+        }
+};
+
+#define PROFILE_SCOPE_CAT(a, b) a##b
+
+#define PROFILE_SCOPE_NAME(line) PROFILE_SCOPE_CAT(profileScope, line)
+
+#ifdef PROFILER_SCOPE_TIMER
+
+/**
+ * time the rest of the enclosing block as a scope of the name
+ */
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_SCOPE_NAME(__LINE__)(name)
+
+#else
+
+#define PROFILE_SCOPE(name)
+
+#endif
+
+#endif // PROFILER_H
@@ -236,6 +236,15 @@ class Projector
                           const unsigned int nThread    /**< [in] the number of threads to be used */
                           );
 
+        /**
+         * @brief Map the 3D projectee onto a padded volume in Fourier space owned by others, e.g. set by another process in the shared memory of the node, without copying it.
+         *
+         * Moreover, it automatically sets the max radius of processing signal.
+         */
+        void mapProjectee(Complex* block,               /**< [in] the padded volume in Fourier space */
+                          const int size                /**< [in] the size of the padded volume */
+                          );
+
         /**
          * @brief Project an image using multiple threads, given the rotation matrix.
          */
@@ -276,6 +285,26 @@ class Projector
                      const unsigned int nThread         /**< [in]  the number of threads to be used */
                      ) const;
 
+        /**
+         * @brief Project an image by the calling thread, given the rotation matrix and the pre-determined pixel indices, while the projected image stored by Complex type. It never enters the OpenMP runtime, thus it is the one to be called in parallel regions.
+         */
+        void project(Complex* dst,                      /**< [out] the projected image, stored by Complex type */
+                     const dmat22& mat,                 /**< [in]  the 2D rotation matrix */
+                     const int* iCol,                   /**< [in]  the index of column */
+                     const int* iRow,                   /**< [in]  the index of row */
+                     const int nPxl                     /**< [in]  the number of pixels */
+                     ) const;
+
+        /**
+         * @brief Project a volume by the calling thread, given the rotation matrix and the pre-determined pixel indices, while the projected image stored by Complex type. It never enters the OpenMP runtime, thus it is the one to be called in parallel regions.
+         */
+        void project(Complex* dst,                      /**< [out] the projected image, stored by Complex type */
+                     const dmat33& mat,                 /**< [in]  the 3D rotation matrix */
+                     const int* iCol,                   /**< [in]  the index of column */
+                     const int* iRow,                   /**< [in]  the index of row */
+                     const int nPxl                     /**< [in]  the number of pixels */
+                     ) const;
+
         /**
          * @brief Project an image using multiple threads, given the rotation matrix and the pre-determined pixel indices, while the projected image stored by Complex type.
          */
@@ -298,6 +327,54 @@ class Projector
                      const unsigned int nThread         /**< [in]  the number of threads to be used */
                      ) const;
 
+        /**
+         * @brief Project an image by the calling thread, given a batch of rotation matrices and the pre-determined pixel indices, while the projected images stored by Complex type one after another.
+         */
+        void projectBatch(Complex* dst,                 /**< [out] the projected images, the m-th one starts at dst + m * nPxl */
+                          const dmat22* mat,            /**< [in]  the 2D rotation matrices */
+                          const int nMat,               /**< [in]  the number of rotation matrices */
+                          const int* iCol,              /**< [in]  the index of column */
+                          const int* iRow,              /**< [in]  the index of row */
+                          const int nPxl                /**< [in]  the number of pixels */
+                          ) const;
+
+        /**
+         * @brief Project a volume by the calling thread, given a batch of rotation matrices and the pre-determined pixel indices, while the projected images stored by Complex type one after another.
+         */
+        void projectBatch(Complex* dst,                 /**< [out] the projected images, the m-th one starts at dst + m * nPxl */
+                          const dmat33* mat,            /**< [in]  the 3D rotation matrices */
+                          const int nMat,               /**< [in]  the number of rotation matrices */
+                          const int* iCol,              /**< [in]  the index of column */
+                          const int* iRow,              /**< [in]  the index of row */
+                          const int nPxl                /**< [in]  the number of pixels */
+                          ) const;
+
+        /**
+         * @brief Project an image using multiple threads, given a batch of rotation matrices and the pre-determined pixel indices, while the projected images stored by Complex type one after another.
+         */
+        void projectBatch(Complex* dst,                 /**< [out] the projected images, the m-th one starts at dst + m * nPxl */
+                          const dmat22* mat,            /**< [in]  the 2D rotation matrices */
+                          const int nMat,               /**< [in]  the number of rotation matrices */
+                          const int* iCol,              /**< [in]  the index of column */
+                          const int* iRow,              /**< [in]  the index of row */
+                          const int nPxl,               /**< [in]  the number of pixels */
+                          const unsigned int nThread    /**< [in]  the number of threads to be used */
+                          ) const;
+
+        /**
+         * @brief Project a volume using multiple threads, given a batch of rotation matrices and the pre-determined pixel indices, while the projected images stored by Complex type one after another.
+         *
+         * The sampled voxels of the whole batch are sorted by slice of the projectee before interpolation, so that lookups of neighbouring rotations share the cache. The eight corners of each linear interpolation are gathered as four pairs of adjacent voxels using SIMD.
+         */
+        void projectBatch(Complex* dst,                 /**< [out] the projected images, the m-th one starts at dst + m * nPxl */
+                          const dmat33* mat,            /**< [in]  the 3D rotation matrices */
+                          const int nMat,               /**< [in]  the number of rotation matrices */
+                          const int* iCol,              /**< [in]  the index of column */
+                          const int* iRow,              /**< [in]  the index of row */
+                          const int nPxl,               /**< [in]  the number of pixels */
+                          const unsigned int nThread    /**< [in]  the number of threads to be used */
+                          ) const;
+
         /**
          * @brief Project an image using multiple threads, given the rotation matrix and the translation vector.
          */
@@ -372,6 +449,18 @@ class Projector
 
     private:
 
+        /**
+         * @brief Project the samples from begin to end of a batch of rotation matrices by linear interpolation, the sample s is the pixel s % nPxl of the rotation matrix s / nPxl.
+         */
+        void projectBatchRange(Complex* dst,            /**< [out] the projected images, the m-th one starts at dst + m * nPxl */
+                               const dmat33* mat,       /**< [in]  the 3D rotation matrices */
+                               const int* iCol,         /**< [in]  the index of column */
+                               const int* iRow,         /**< [in]  the index of row */
+                               const int nPxl,          /**< [in]  the number of pixels */
+                               const size_t begin,      /**< [in]  the first sample */
+                               const size_t end         /**< [in]  the sample after the last one */
+                               ) const;
+
         /**
          * @brief Perform griding correction on projectee.
          */
@@ -45,6 +45,9 @@
 #include "TabFunction.h"
 #include "Spectrum.h"
 #include "Mask.h"
+#include "CTF.h"
+#include "Database.h"
+#include "Profiler.h"
 
 #ifdef GPU_VERSION
 #include "Interface.h"
@@ -74,6 +77,57 @@
 
 #define FSC_BASE_H (1 - 1e-3)
 
+#ifdef RECONSTRUCTOR_INSERT_SLAB
+#define RECONSTRUCTOR_INSERT_BUFFERED
+#elif defined(RECONSTRUCTOR_INSERT_PRIVATE)
+#define RECONSTRUCTOR_INSERT_BUFFERED
+#endif
+
+/**
+ * number of z-slabs owned by each thread when flushing the inserting records
+ */
+#define RECONSTRUCTOR_INSERT_SLAB_PER_THREAD 4
+
+/**
+ * number of (image, pose) samples inserted by insertI between two flushes of the buffered insertion
+ */
+#define RECONSTRUCTOR_INSERT_I_BLOCK 1024
+
+#ifdef RECONSTRUCTOR_INSERT_SLAB
+
+/**
+ * @brief A trilinear contribution of a pixel to _F3D and _T3D, recorded during insertion and applied by the owner of its z-slab during flushing.
+ */
+struct InsertRecord
+{
+    /**
+     * index of the (0, 0, 0) corner of the interpolation box in the volume
+     */
+    size_t index;
+
+    /**
+     * the trilinear interpolation weights of the eight corners
+     */
+    RFLOAT w[2][2][2];
+
+    /**
+     * the value added to _F3D
+     */
+    Complex f;
+
+    /**
+     * the value added to _T3D
+     */
+    RFLOAT t;
+
+    /**
+     * the planes of the box to be applied, bit 0 for the lower plane and bit 1 for the upper plane
+     */
+    int plane;
+};
+
+#endif
+
 /**
  * @brief The 2D and 3D model reconstruction class. 
  * It provides all APIs that are used for reconstructing a 2D/3D Fourier transform of a 2D/3D model in 2D/3D Fourier space from the pixel data of 2D Fourier transform of real images and the associated 5D coordinates which are learned from sampling in the former round. 
@@ -169,6 +223,53 @@ class Reconstructor : public Parallel
          */
         Volume _T3D;
 
+#ifdef RECONSTRUCTOR_INSERT_SLAB
+
+        /**
+         * @brief the number of z-slabs which the active region of _F3D and _T3D is divided into
+         */
+        int _nInsertSlab;
+
+        /**
+         * @brief the inserting records, binned by the inserting thread and the destination z-slab (thread * _nInsertSlab + slab)
+         */
+        vector<vector<InsertRecord> > _insertBin;
+
+#endif
+
+#ifdef RECONSTRUCTOR_ALLREDUCE_SHELL
+
+        /**
+         * @brief the indices of voxels of _F3D and _T3D inside the active shell, the only voxels which may be non-zero after insertion, thus the only voxels reduced among processes
+         */
+        vector<size_t> _shellIndex;
+
+        /**
+         * @brief the radius of the active shell which _shellIndex is built for, -1 stands for not built
+         */
+        int _shellRadius;
+
+#endif
+
+#ifdef RECONSTRUCTOR_INSERT_PRIVATE
+
+        /**
+         * @brief the private accumulators of _F3D of each thread, allocated on the first insertion
+         */
+        vector<Complex*> _insertF;
+
+        /**
+         * @brief the private accumulators of _T3D of each thread, allocated on the first insertion
+         */
+        vector<RFLOAT*> _insertT;
+
+        /**
+         * @brief the extent of the region touched by each thread in its private accumulators
+         */
+        vector<int> _insertExtent;
+
+#endif
+
         /**
          * @brief the vector to save the rotation matrices of each insertion with image and associated 5D coordinates. 
          * Since 2D Fourier transform of each image is a slice extracted from a particular direction in the 3D Fourier transform domain, rotation matrices that project the image's 2D coordinate(x,y), associated the third coordinate z always being 0, onto its real location in the 3D space can be obtained by the 5D coordinates of the image. Every inserting operation will also insert the rotation matrix into this vector. 
@@ -326,6 +427,10 @@ class Reconstructor : public Parallel
             _oz = 0;
 
             _counter = 0;
+
+#ifdef RECONSTRUCTOR_ALLREDUCE_SHELL
+            _shellRadius = -1;
+#endif
         }
 
     public:
@@ -614,6 +719,41 @@ class Reconstructor : public Parallel
                      const vec*     sig = NULL /**< [in] the average power spectrum of noise */
                     );
 
+#ifdef RECONSTRUCTOR_INSERT_BUFFERED
+
+        /**
+         * @brief Apply the contributions buffered by insertP into _F3D and _T3D. Insertion in 3D mode writes into per-thread buffers instead of updating _F3D and _T3D atomically, so this function must be called outside any parallel region after the inserting threads finish and before _F3D or _T3D is read or reduced.
+         */
+        void flushInsertP();
+
+#endif
+
+#ifndef GPU_INSERT
+
+        /**
+         * @brief Insert the complex 2D images into reconstructor by CPU, taking the packed arrays of the GPU version. Each image carries mReco poses (nr as quaternions, nt as translations, nd as defocus factors). The coordinates of pixels of a pose are rotated in bulk, the translation is applied as the product of a column and a row phase ramp, and the contributions are binned by destination when insertion is buffered. Only the 3D mode is supported.
+         */
+        void insertI(Complex* datP,      /**< [in] the complex image data of all images, image major */
+                     RFLOAT*  ctfP,      /**< [in] the CTF of all images, used when CTF search is off */
+                     int*     ctfIdx,    /**< [in] the row of ctfP of each image, NULL if ctfP holds one row per image */
+                     RFLOAT*  sigP,      /**< [in] the average power spectrum of noise of all images */
+                     int*     sigIdx,    /**< [in] the row of sigP of each image, NULL if sigP holds one row per image */
+                     RFLOAT*  w,         /**< [in] the weights of each image */
+                     double*  offS,      /**< [in] the offsets of each image */
+                     double*  nr,        /**< [in] the quaternions of poses */
+                     double*  nt,        /**< [in] the translations of poses */
+                     double*  nd,        /**< [in] the defocus factors of poses */
+                     CTFAttr* ctfaData,  /**< [in] the CTF attributes of each image, used when CTF search is on */
+                     RFLOAT   pixelSize, /**< [in] pixel size */
+                     bool     cSearch,   /**< [in] the indicator of whther to perform ctf search or not */
+                     int      opf,       /**< [in] the padding factor of coordinates of pixels */
+                     int      mReco,     /**< [in] the number of poses of each image */
+                     int      idim,      /**< [in] boxsize of image */
+                     int      imgNum     /**< [in] number of images */
+                    );
+
+#endif
+
 #ifdef GPU_INSERT
 
         /**
@@ -748,6 +888,30 @@ class Reconstructor : public Parallel
          */
         void allReduceO();
 
+#ifdef RECONSTRUCTOR_ALLREDUCE_SHELL
+
+        /**
+         * @brief Build the indices of voxels inside the active shell of _F3D and _T3D, whose radius is _maxRadius * _pf plus the reach of the interpolation kernel. It is rebuilt only when the radius changes.
+         */
+        void buildShell();
+
+#endif
+
+#ifdef RECONSTRUCTOR_INSERT_BUFFERED
+
+        /**
+         * @brief Insert a value of a pixel at an irregular voxel into the buffers of a thread, which is applied to _F3D and _T3D in flushInsertP.
+         */
+        void insertBuffered(const int thread,   /**< [in] the index of the inserting thread */
+                            Complex f,          /**< [in] the value to be added into _F3D */
+                            const RFLOAT t,     /**< [in] the value to be added into _T3D */
+                            RFLOAT iCol,        /**< [in] the column index of the irregular voxel */
+                            RFLOAT iRow,        /**< [in] the row index of the irregular voxel */
+                            RFLOAT iSlc         /**< [in] the slice index of the irregular voxel */
+                           );
+
+#endif
+
         /**
          * @brief Calculate the distance to total balanced. The distance is the summation of diffrernces between real weights and ideal total balance weights, calculated by @f$\sum_{i^2+j^2+k^2<\left({maxradius}*{pf}\right)^2}\left(\left|C\left(i,j,k\right)\right|-1\right)@f$ .
          *
@@ -8,6 +8,80 @@
 
 #include "CTF.h"
 
+#ifdef SINGLE_PRECISION
+
+/**
+ * pi split into three parts for the range reduction of sine, the first two
+ * parts have few enough bits that their products with the quotient are exact
+ */
+#define CTF_SIN_PI_A 3.140625f
+#define CTF_SIN_PI_B 9.67502593994140625e-4f
+#define CTF_SIN_PI_C 1.509957990978376432e-7f
+
+#ifdef ENABLE_SIMD_512
+
+static inline __m512 sin512Float(__m512 x)
+{
+    // x = q * pi + r, |r| <= pi / 2, sin(x) = (-1)^q * sin(r)
+
+    __m512 q = _mm512_roundscale_ps(_mm512_mul_ps(x, _mm512_set1_ps(M_1_PI)), _MM_FROUND_TO_NEAREST_INT);
+
+    __m512 r = _mm512_sub_ps(x, _mm512_mul_ps(q, _mm512_set1_ps(CTF_SIN_PI_A)));
+    r = _mm512_sub_ps(r, _mm512_mul_ps(q, _mm512_set1_ps(CTF_SIN_PI_B)));
+    r = _mm512_sub_ps(r, _mm512_mul_ps(q, _mm512_set1_ps(CTF_SIN_PI_C)));
+
+    __m512 h = _mm512_mul_ps(q, _mm512_set1_ps(0.5f));
+    __m512 sign = _mm512_sub_ps(_mm512_set1_ps(1.0f),
+                                _mm512_mul_ps(_mm512_set1_ps(4.0f),
+                                              _mm512_sub_ps(h, _mm512_roundscale_ps(h, _MM_FROUND_TO_NEG_INF))));
+
+    __m512 r2 = _mm512_mul_ps(r, r);
+
+    __m512 p = _mm512_set1_ps(-2.5052108385e-8f);
+    p = _mm512_add_ps(_mm512_mul_ps(p, r2), _mm512_set1_ps(2.7557319224e-6f));
+    p = _mm512_add_ps(_mm512_mul_ps(p, r2), _mm512_set1_ps(-1.9841269841e-4f));
+    p = _mm512_add_ps(_mm512_mul_ps(p, r2), _mm512_set1_ps(8.3333333333e-3f));
+    p = _mm512_add_ps(_mm512_mul_ps(p, r2), _mm512_set1_ps(-1.6666666667e-1f));
+    p = _mm512_add_ps(_mm512_mul_ps(_mm512_mul_ps(p, r2), r), r);
+
+    return _mm512_mul_ps(p, sign);
+}
+
+#else
+#ifdef ENABLE_SIMD_256
+
+static inline __m256 sin256Float(__m256 x)
+{
+    // x = q * pi + r, |r| <= pi / 2, sin(x) = (-1)^q * sin(r)
+
+    __m256 q = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(M_1_PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+
+    __m256 r = _mm256_sub_ps(x, _mm256_mul_ps(q, _mm256_set1_ps(CTF_SIN_PI_A)));
+    r = _mm256_sub_ps(r, _mm256_mul_ps(q, _mm256_set1_ps(CTF_SIN_PI_B)));
+    r = _mm256_sub_ps(r, _mm256_mul_ps(q, _mm256_set1_ps(CTF_SIN_PI_C)));
+
+    __m256 h = _mm256_mul_ps(q, _mm256_set1_ps(0.5f));
+    __m256 sign = _mm256_sub_ps(_mm256_set1_ps(1.0f),
+                                _mm256_mul_ps(_mm256_set1_ps(4.0f),
+                                              _mm256_sub_ps(h, _mm256_floor_ps(h))));
+
+    __m256 r2 = _mm256_mul_ps(r, r);
+
+    __m256 p = _mm256_set1_ps(-2.5052108385e-8f);
+    p = _mm256_add_ps(_mm256_mul_ps(p, r2), _mm256_set1_ps(2.7557319224e-6f));
+    p = _mm256_add_ps(_mm256_mul_ps(p, r2), _mm256_set1_ps(-1.9841269841e-4f));
+    p = _mm256_add_ps(_mm256_mul_ps(p, r2), _mm256_set1_ps(8.3333333333e-3f));
+    p = _mm256_add_ps(_mm256_mul_ps(p, r2), _mm256_set1_ps(-1.6666666667e-1f));
+    p = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(p, r2), r), r);
+
+    return _mm256_mul_ps(p, sign);
+}
+
+#endif
+#endif
+
+#endif
+
 RFLOAT CTF(const RFLOAT f,
            const RFLOAT voltage,
            const RFLOAT defocus,
@@ -143,3 +217,99 @@ void CTF(RFLOAT* dst,
         dst[i] = -w1 * TS_SIN(ki) + w2 * TS_COS(ki);
     }
 }
+
+void CTF(RFLOAT* dst,
+         const RFLOAT voltage,
+         const RFLOAT defocusU,
+         const RFLOAT defocusV,
+         const RFLOAT theta,
+         const RFLOAT Cs,
+         const RFLOAT amplitudeContrast,
+         const RFLOAT phaseShift,
+         const RFLOAT* frequency,
+         const RFLOAT* cos2Angle,
+         const RFLOAT* sin2Angle,
+         const int nPxl)
+{
+    RFLOAT lambda = 12.2643247 / sqrt(voltage * (1 + voltage * 0.978466e-6));
+
+    RFLOAT K1 = M_PI * lambda;
+    RFLOAT K2 = M_PI_2 * Cs * TSGSL_pow_3(lambda);
+
+    // defocus = -(defocusAvg + defocusCos * cos(2 * angle) + defocusSin * sin(2 * angle))
+
+    RFLOAT defocusAvg = (defocusU + defocusV) / 2;
+    RFLOAT defocusCos = (defocusU - defocusV) / 2 * TS_COS(2 * theta);
+    RFLOAT defocusSin = (defocusU - defocusV) / 2 * TS_SIN(2 * theta);
+
+    // -sqrt(1 - A^2) * sin(ki) + A * cos(ki) = -sin(ki - asin(A))
+
+    RFLOAT phase = phaseShift + asin(amplitudeContrast);
+
+    int i = 0;
+
+#ifdef SINGLE_PRECISION
+#ifdef ENABLE_SIMD_512
+    __m512 vK1 = _mm512_set1_ps(-K1);
+    __m512 vK2 = _mm512_set1_ps(K2);
+    __m512 vAvg = _mm512_set1_ps(defocusAvg);
+    __m512 vCos = _mm512_set1_ps(defocusCos);
+    __m512 vSin = _mm512_set1_ps(defocusSin);
+    __m512 vPhase = _mm512_set1_ps(phase);
+
+    for (; i <= nPxl - 16; i += 16)
+    {
+        __m512 f2 = _mm512_loadu_ps(frequency + i);
+        f2 = _mm512_mul_ps(f2, f2);
+
+        __m512 defocus = _mm512_add_ps(vAvg,
+                                       _mm512_add_ps(_mm512_mul_ps(vCos, _mm512_loadu_ps(cos2Angle + i)),
+                                                     _mm512_mul_ps(vSin, _mm512_loadu_ps(sin2Angle + i))));
+
+        __m512 ki = _mm512_mul_ps(_mm512_add_ps(_mm512_mul_ps(vK1, defocus),
+                                                _mm512_mul_ps(vK2, f2)),
+                                  f2);
+
+        _mm512_storeu_ps(dst + i, _mm512_sub_ps(_mm512_setzero_ps(), sin512Float(_mm512_sub_ps(ki, vPhase))));
+    }
+#else
+#ifdef ENABLE_SIMD_256
+    __m256 vK1 = _mm256_set1_ps(-K1);
+    __m256 vK2 = _mm256_set1_ps(K2);
+    __m256 vAvg = _mm256_set1_ps(defocusAvg);
+    __m256 vCos = _mm256_set1_ps(defocusCos);
+    __m256 vSin = _mm256_set1_ps(defocusSin);
+    __m256 vPhase = _mm256_set1_ps(phase);
+
+    for (; i <= nPxl - 8; i += 8)
+    {
+        __m256 f2 = _mm256_loadu_ps(frequency + i);
+        f2 = _mm256_mul_ps(f2, f2);
+
+        __m256 defocus = _mm256_add_ps(vAvg,
+                                       _mm256_add_ps(_mm256_mul_ps(vCos, _mm256_loadu_ps(cos2Angle + i)),
+                                                     _mm256_mul_ps(vSin, _mm256_loadu_ps(sin2Angle + i))));
+
+        __m256 ki = _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(vK1, defocus),
+                                                _mm256_mul_ps(vK2, f2)),
+                                  f2);
+
+        _mm256_storeu_ps(dst + i, _mm256_sub_ps(_mm256_setzero_ps(), sin256Float(_mm256_sub_ps(ki, vPhase))));
+    }
+#endif
+#endif
+#endif
+
+    for (; i < nPxl; i++)
+    {
+        RFLOAT f2 = TSGSL_pow_2(frequency[i]);
+
+        RFLOAT defocus = -(defocusAvg
+                         + defocusCos * cos2Angle[i]
+                         + defocusSin * sin2Angle[i]);
+
+        RFLOAT ki = K1 * defocus * f2 + K2 * TSGSL_pow_2(f2);
+
+        dst[i] = -TS_SIN(ki - phase);
+    }
+}
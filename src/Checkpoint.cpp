@@ -0,0 +1,159 @@
+/*******************************************************************************
+ * Author: Mingxu Hu
+ * Dependency:
+ * Test:
+ * Execution:
+ * Description:
+ *
+ * Manual:
+ * ****************************************************************************/
+
+#include "Checkpoint.h"
+#include "Parallel.h"
+
+#include <cstdio>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+Checkpoint::Checkpoint() : _buf(sizeof(unsigned long long), '\0'),
+                           _pos(sizeof(unsigned long long)) {}
+
+void Checkpoint::check(const size_t size) const
+{
+    if (_pos + size > _buf.size())
+    {
+        REPORT_ERROR("CHECKPOINT ENDS UNEXPECTEDLY");
+
+        abort();
+    }
+}
+
+void Checkpoint::write(const char* filename,
+                       MPI_Comm comm)
+{
+    unsigned long long size = _buf.size();
+
+    memcpy(&_buf[0], &size, sizeof(size));
+
+    std::string tmp = std::string(filename) + ".tmp";
+
+    MPI_Write_Ordered_Large(tmp.c_str(), _buf.data(), _buf.size(), comm);
+
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+
+    if (rank == 0)
+    {
+        if (rename(tmp.c_str(), filename) != 0)
+        {
+            REPORT_ERROR("FAIL TO RENAME CHECKPOINT");
+
+            abort();
+        }
+    }
+
+    MPI_Barrier(comm);
+}
+
+void Checkpoint::read(const char* filename,
+                      MPI_Comm comm)
+{
+    int rank, commSize;
+
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &commSize);
+
+    int fd = open(filename, O_RDONLY);
+
+    if (fd == -1)
+    {
+        REPORT_ERROR("FAIL TO OPEN CHECKPOINT");
+
+        abort();
+    }
+
+    // the offset and size of the buffer of each process
+
+    std::vector<unsigned long long> index(2 * commSize);
+
+    if (rank == 0)
+    {
+        struct stat st;
+
+        if (fstat(fd, &st) == -1)
+        {
+            REPORT_ERROR("FAIL TO STAT CHECKPOINT");
+
+            abort();
+        }
+
+        unsigned long long offset = 0;
+
+        for (int i = 0; i < commSize; i++)
+        {
+            unsigned long long size = 0;
+
+            if ((offset + sizeof(size) > (unsigned long long)st.st_size) ||
+                (pread(fd, &size, sizeof(size), offset) != sizeof(size)) ||
+                (size < sizeof(size)))
+            {
+                CLOG(FATAL, "LOGGER_SYS") << "Checkpoint "
+                                          << filename
+                                          << " Holds Less Than "
+                                          << commSize
+                                          << " Processes";
+
+                abort();
+            }
+
+            index[2 * i] = offset;
+            index[2 * i + 1] = size;
+
+            offset += size;
+        }
+
+        if (offset != (unsigned long long)st.st_size)
+        {
+            CLOG(FATAL, "LOGGER_SYS") << "Checkpoint "
+                                      << filename
+                                      << " Holds More Than "
+                                      << commSize
+                                      << " Processes";
+
+            abort();
+        }
+    }
+
+    unsigned long long local[2];
+
+    MPI_Scatter(&index[0], 2, MPI_UNSIGNED_LONG_LONG, local, 2, MPI_UNSIGNED_LONG_LONG, 0, comm);
+
+    _buf.resize(local[1]);
+
+    char* ptr = &_buf[0];
+
+    unsigned long long offset = local[0];
+    unsigned long long size = local[1];
+
+    while (size > 0)
+    {
+        ssize_t n = pread(fd, ptr, size, offset);
+
+        if (n <= 0)
+        {
+            REPORT_ERROR("FAIL TO READ CHECKPOINT");
+
+            abort();
+        }
+
+        ptr += n;
+        size -= n;
+        offset += n;
+    }
+
+    close(fd);
+
+    _pos = sizeof(unsigned long long);
+}
@@ -8,19 +8,36 @@
 
 #include "Database.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 Database::Database()
 {
     _db = NULL;
+
+    _binary = false;
+    _map = NULL;
+    _mapSize = 0;
 }
 
 Database::Database(const char database[])
 {
+    _db = NULL;
+
+    _binary = false;
+    _map = NULL;
+    _mapSize = 0;
+
     openDatabase(database);
 }
 
 Database::~Database()
 {
-    fclose(_db);
+    if (_db != NULL) fclose(_db);
+
+    if (_map != NULL) munmap(_map, _mapSize);
 }
 
 void Database::openDatabase(const char database[])
@@ -28,6 +45,47 @@ void Database::openDatabase(const char database[])
     _db = fopen(database, "r");
 
     if (_db == NULL) REPORT_ERROR("FAIL TO OPEN DATABASE");
+
+    char magic[8];
+
+    _binary = ((fread(magic, 1, 8, _db) == 8)
+            && (strncmp(magic, THB_MAGIC, 8) == 0));
+
+    if (!_binary)
+    {
+        rewind(_db);
+
+        return;
+    }
+
+    fclose(_db);
+    _db = NULL;
+
+    int fd = open(database, O_RDONLY);
+
+    if (fd == -1) REPORT_ERROR("FAIL TO OPEN DATABASE");
+
+    struct stat st;
+
+    if (fstat(fd, &st) == -1) REPORT_ERROR("FAIL TO STAT DATABASE");
+
+    _mapSize = st.st_size;
+
+    _map = (char*)mmap(NULL, _mapSize, PROT_READ, MAP_SHARED, fd, 0);
+
+    close(fd);
+
+    if (_map == MAP_FAILED)
+    {
+        _map = NULL;
+
+        REPORT_ERROR("FAIL TO MAP DATABASE");
+    }
+
+    if ((_mapSize < sizeof(THBHeader)) ||
+        (header().nField != THU_N_FIELD) ||
+        (header().strTable + header().strSize > _mapSize))
+        REPORT_ERROR("CORRUPTED BINARY DATABASE");
 }
 
 void Database::saveDatabase(const char database[])
@@ -35,8 +93,305 @@ void Database::saveDatabase(const char database[])
     // TODO
 }
 
+void Database::saveDatabaseBinary(const char database[],
+                                  const vector<THURecord>& records,
+                                  MPI_Comm comm)
+{
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+
+    unsigned long long local[2] = {records.size(), 0};
+
+    int nGroup = 0;
+
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        local[1] += records[i].path.size() + 1
+                  + records[i].micrographPath.size() + 1;
+
+        nGroup = GSL_MAX_INT(nGroup, (int)records[i].field[THU_GROUP_ID]);
+    }
+
+    // position of the particles and the strings of this process
+
+    unsigned long long begin[2] = {0, 0};
+    unsigned long long total[2];
+
+    MPI_Exscan(local, begin, 2, MPI_UNSIGNED_LONG_LONG, MPI_SUM, comm);
+
+    if (rank == 0) begin[0] = begin[1] = 0;
+
+    MPI_Allreduce(local, total, 2, MPI_UNSIGNED_LONG_LONG, MPI_SUM, comm);
+
+    MPI_Allreduce(MPI_IN_PLACE, &nGroup, 1, MPI_INT, MPI_MAX, comm);
+
+    THBHeader header;
+
+    initHeaderBinary(header, total[0], nGroup, total[1]);
+
+    if (rank == 0)
+    {
+        int fd = open(database, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+        if (fd == -1) REPORT_ERROR("FAIL TO CREATE DATABASE");
+
+        if ((pwrite(fd, &header, sizeof(THBHeader), 0) != sizeof(THBHeader)) ||
+            (ftruncate(fd, header.strTable + header.strSize) == -1))
+            REPORT_ERROR("FAIL TO WRITE DATABASE");
+
+        close(fd);
+    }
+
+    MPI_Barrier(comm);
+
+    int fd = open(database, O_WRONLY);
+
+    if (fd == -1) REPORT_ERROR("FAIL TO OPEN DATABASE");
+
+    if (!records.empty())
+        writeBinary(fd, header, &records[0], records.size(), begin[0], begin[1]);
+
+    close(fd);
+
+    MPI_Barrier(comm);
+}
+
+void Database::convertDatabase(const char src[],
+                               const char dst[])
+{
+    FILE* file = fopen(src, "r");
+
+    if (file == NULL) REPORT_ERROR("FAIL TO OPEN DATABASE");
+
+    char* line = new char[FILE_LINE_LENGTH];
+
+    THURecord record;
+
+    // first pass, determine the layout
+
+    size_t nParticle = 0;
+    size_t strSize = 0;
+    int nGroup = 0;
+
+    while (fgets(line, FILE_LINE_LENGTH - 1, file))
+    {
+        parseLine(record, line);
+
+        nParticle++;
+
+        strSize += record.path.size() + 1
+                 + record.micrographPath.size() + 1;
+
+        nGroup = GSL_MAX_INT(nGroup, (int)record.field[THU_GROUP_ID]);
+    }
+
+    THBHeader header;
+
+    initHeaderBinary(header, nParticle, nGroup, strSize);
+
+    int fd = open(dst, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (fd == -1) REPORT_ERROR("FAIL TO CREATE DATABASE");
+
+    if ((pwrite(fd, &header, sizeof(THBHeader), 0) != sizeof(THBHeader)) ||
+        (ftruncate(fd, header.strTable + header.strSize) == -1))
+        REPORT_ERROR("FAIL TO WRITE DATABASE");
+
+    // second pass, write particles chunk by chunk
+
+    rewind(file);
+
+    vector<THURecord> records;
+    records.reserve(THB_CONVERT_CHUNK);
+
+    size_t iBegin = 0;
+    size_t strBegin = 0;
+
+    while (true)
+    {
+        bool eof = (fgets(line, FILE_LINE_LENGTH - 1, file) == NULL);
+
+        if (!eof)
+        {
+            records.push_back(THURecord());
+
+            parseLine(records.back(), line);
+        }
+
+        if ((eof && !records.empty()) || (records.size() == THB_CONVERT_CHUNK))
+        {
+            writeBinary(fd, header, &records[0], records.size(), iBegin, strBegin);
+
+            iBegin += records.size();
+
+            for (size_t i = 0; i < records.size(); i++)
+                strBegin += records[i].path.size() + 1
+                          + records[i].micrographPath.size() + 1;
+
+            records.clear();
+        }
+
+        if (eof) break;
+    }
+
+    close(fd);
+
+    fclose(file);
+
+    delete[] line;
+}
+
+void Database::parseLine(THURecord& dst,
+                         char* line)
+{
+    char* word = strtok(line, " \t\n");
+
+    for (int f = 0; f < THU_N_FIELD; f++)
+    {
+        if (word == NULL) REPORT_ERROR("INCOMPLETE LINE IN DATABASE");
+
+        if (f == THU_PARTICLE_PATH)
+        {
+            dst.path = word;
+            dst.field[f] = 0;
+        }
+        else if (f == THU_MICROGRAPH_PATH)
+        {
+            dst.micrographPath = word;
+            dst.field[f] = 0;
+        }
+        else
+            dst.field[f] = atof(word);
+
+        word = strtok(NULL, " \t\n");
+    }
+}
+
+size_t Database::widthBinary(const int f)
+{
+    if ((f == THU_PARTICLE_PATH) || (f == THU_MICROGRAPH_PATH))
+        return sizeof(uint64_t);
+    else if ((f == THU_GROUP_ID) || (f == THU_CLASS_ID))
+        return sizeof(int32_t);
+    else
+        return sizeof(double);
+}
+
+void Database::initHeaderBinary(THBHeader& header,
+                                const size_t nParticle,
+                                const int nGroup,
+                                const size_t strSize)
+{
+    memset(&header, 0, sizeof(THBHeader));
+
+    memcpy(header.magic, THB_MAGIC, 8);
+
+    header.nParticle = nParticle;
+    header.nGroup = nGroup;
+    header.nField = THU_N_FIELD;
+
+    uint64_t offset = sizeof(THBHeader);
+
+    for (int f = 0; f < THU_N_FIELD; f++)
+    {
+        header.column[f] = offset;
+
+        // pad each column to 8 bytes
+        offset += (nParticle * widthBinary(f) + 7) / 8 * 8;
+    }
+
+    header.strTable = offset;
+    header.strSize = strSize;
+}
+
+/**
+ * write the whole buffer at the given offset of file
+ */
+static void pwriteAll(const int fd,
+                      const char* buf,
+                      size_t size,
+                      off_t offset)
+{
+    while (size > 0)
+    {
+        ssize_t n = pwrite(fd, buf, size, offset);
+
+        if (n <= 0) REPORT_ERROR("FAIL TO WRITE DATABASE");
+
+        buf += n;
+        size -= n;
+        offset += n;
+    }
+}
+
+void Database::writeBinary(const int fd,
+                           const THBHeader& header,
+                           const THURecord* records,
+                           const size_t n,
+                           const size_t iBegin,
+                           const size_t strBegin)
+{
+    vector<char> column(n * sizeof(double));
+
+    for (int f = 0; f < THU_N_FIELD; f++)
+    {
+        size_t width = widthBinary(f);
+
+        if (f == THU_PARTICLE_PATH)
+        {
+            // the paths of a particle are stored one after another
+            uint64_t offset = strBegin;
+
+            for (size_t i = 0; i < n; i++)
+            {
+                ((uint64_t*)&column[0])[i] = offset;
+
+                offset += records[i].path.size() + 1
+                        + records[i].micrographPath.size() + 1;
+            }
+        }
+        else if (f == THU_MICROGRAPH_PATH)
+        {
+            uint64_t offset = strBegin;
+
+            for (size_t i = 0; i < n; i++)
+            {
+                offset += records[i].path.size() + 1;
+
+                ((uint64_t*)&column[0])[i] = offset;
+
+                offset += records[i].micrographPath.size() + 1;
+            }
+        }
+        else if (width == sizeof(int32_t))
+        {
+            for (size_t i = 0; i < n; i++)
+                ((int32_t*)&column[0])[i] = (int32_t)records[i].field[f];
+        }
+        else
+        {
+            for (size_t i = 0; i < n; i++)
+                ((double*)&column[0])[i] = records[i].field[f];
+        }
+
+        pwriteAll(fd, &column[0], n * width, header.column[f] + iBegin * width);
+    }
+
+    string str;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        str.append(records[i].path.c_str(), records[i].path.size() + 1);
+        str.append(records[i].micrographPath.c_str(), records[i].micrographPath.size() + 1);
+    }
+
+    pwriteAll(fd, str.data(), str.size(), header.strTable + strBegin);
+}
+
 int Database::nParticle() const
 {
+    if (_binary) return header().nParticle;
+
     rewind(_db);
 
     int result = 0;
@@ -57,6 +412,8 @@ int Database::nParticle() const
 
 int Database::nGroup() const
 {
+    if (_binary) return header().nGroup;
+
     rewind(_db);
 
     int result = 0;
@@ -106,6 +463,15 @@ void Database::index()
 {
     _offset.resize(nParticle());
 
+    if (_binary)
+    {
+        // particles are accessed by their ID directly
+        for (int i = 0; i < (int)_offset.size(); i++)
+            _offset[i] = i;
+
+        return;
+    }
+
     rewind(_db);
 
     char line[FILE_LINE_LENGTH];
@@ -146,6 +512,36 @@ void Database::shuffle()
     MPI_Barrier(MPI_COMM_WORLD);
 }
 
+void Database::shuffle(const vector<int>& reg)
+{
+    _reg.resize(nParticle());
+
+    IF_MASTER
+    {
+        if (reg.size() != _reg.size())
+        {
+            CLOG(FATAL, "LOGGER_SYS") << "Number of Particles in Checkpoint is "
+                                      << reg.size()
+                                      << ", but "
+                                      << _reg.size()
+                                      << " in Database";
+
+            abort();
+        }
+
+        _reg = reg;
+    }
+
+    MPI_Bcast(&_reg[0], _reg.size(), MPI_INT, MASTER_ID, MPI_COMM_WORLD);
+
+    MPI_Barrier(MPI_COMM_WORLD);
+}
+
+const vector<int>& Database::reg() const
+{
+    return _reg;
+}
+
 long Database::offset(const int i) const
 {
     return _offset[_reg[i]];
@@ -153,6 +549,8 @@ long Database::offset(const int i) const
 
 RFLOAT Database::coordX(const int i) const
 {
+    if (_binary) return (int)field(THU_COORDINATE_X, i);
+
     fseek(_db, _offset[_reg[i]], SEEK_SET);
 
     char line[FILE_LINE_LENGTH];
@@ -170,6 +568,8 @@ RFLOAT Database::coordX(const int i) const
 
 RFLOAT Database::coordY(const int i) const
 {
+    if (_binary) return (int)field(THU_COORDINATE_Y, i);
+
     fseek(_db, _offset[_reg[i]], SEEK_SET);
 
     char line[FILE_LINE_LENGTH];
@@ -187,6 +587,8 @@ RFLOAT Database::coordY(const int i) const
 
 int Database::groupID(const int i) const
 {
+    if (_binary) return fieldInt(THU_GROUP_ID, i);
+
     fseek(_db, _offset[_reg[i]], SEEK_SET);
 
     char line[FILE_LINE_LENGTH];
@@ -204,6 +606,8 @@ int Database::groupID(const int i) const
 
 string Database::path(const int i) const
 {
+    if (_binary) return string(fieldStr(THU_PARTICLE_PATH, i));
+
     fseek(_db, _offset[_reg[i]], SEEK_SET);
 
     char line[FILE_LINE_LENGTH];
@@ -221,6 +625,8 @@ string Database::path(const int i) const
 
 string Database::micrographPath(const int i) const
 {
+    if (_binary) return string(fieldStr(THU_MICROGRAPH_PATH, i));
+
     fseek(_db, _offset[_reg[i]], SEEK_SET);
 
     char line[FILE_LINE_LENGTH];
@@ -245,6 +651,19 @@ void Database::ctf(RFLOAT& voltage,
                    RFLOAT& phaseShift,
                    const int i) const
 {
+    if (_binary)
+    {
+        voltage = field(THU_VOLTAGE, i);
+        defocusU = field(THU_DEFOCUS_U, i);
+        defocusV = field(THU_DEFOCUS_V, i);
+        defocusTheta = field(THU_DEFOCUS_THETA, i);
+        Cs = field(THU_CS, i);
+        amplitudeConstrast = field(THU_AMPLITUTDE_CONTRAST, i);
+        phaseShift = field(THU_PHASE_SHIFT, i);
+
+        return;
+    }
+
     fseek(_db, _offset[_reg[i]], SEEK_SET);
 
     char line[FILE_LINE_LENGTH];
@@ -296,6 +715,8 @@ void Database::ctf(CTFAttr& dst,
 
 int Database::cls(const int i) const
 {
+    if (_binary) return fieldInt(THU_CLASS_ID, i);
+
     fseek(_db, _offset[_reg[i]], SEEK_SET);
 
     char line[FILE_LINE_LENGTH];
@@ -313,6 +734,16 @@ int Database::cls(const int i) const
 
 dvec4 Database::quat(const int i) const
 {
+    if (_binary)
+    {
+        dvec4 result;
+
+        for (int j = 0; j < 4; j++)
+            result(j) = field(THU_QUATERNION_0 + j, i);
+
+        return result;
+    }
+
     fseek(_db, _offset[_reg[i]], SEEK_SET);
 
     char line[FILE_LINE_LENGTH];
@@ -346,6 +777,8 @@ dvec4 Database::quat(const int i) const
 
 RFLOAT Database::k1(const int i) const
 {
+    if (_binary) return field(THU_K1, i);
+
     fseek(_db, _offset[_reg[i]], SEEK_SET);
 
     char line[FILE_LINE_LENGTH];
@@ -363,6 +796,8 @@ RFLOAT Database::k1(const int i) const
 
 RFLOAT Database::k2(const int i) const
 {
+    if (_binary) return field(THU_K2, i);
+
     fseek(_db, _offset[_reg[i]], SEEK_SET);
 
     char line[FILE_LINE_LENGTH];
@@ -380,6 +815,8 @@ RFLOAT Database::k2(const int i) const
 
 RFLOAT Database::k3(const int i) const
 {
+    if (_binary) return field(THU_K3, i);
+
     fseek(_db, _offset[_reg[i]], SEEK_SET);
 
     char line[FILE_LINE_LENGTH];
@@ -397,6 +834,16 @@ RFLOAT Database::k3(const int i) const
 
 dvec2 Database::tran(const int i) const
 {
+    if (_binary)
+    {
+        dvec2 result;
+
+        result(0) = field(THU_TRANSLATION_X, i);
+        result(1) = field(THU_TRANSLATION_Y, i);
+
+        return result;
+    }
+
     fseek(_db, _offset[_reg[i]], SEEK_SET);
 
     char line[FILE_LINE_LENGTH];
@@ -422,6 +869,8 @@ dvec2 Database::tran(const int i) const
 
 RFLOAT Database::stdTX(const int i) const
 {
+    if (_binary) return field(THU_STD_TRANSLATION_X, i);
+
     fseek(_db, _offset[_reg[i]], SEEK_SET);
 
     char line[FILE_LINE_LENGTH];
@@ -439,6 +888,8 @@ RFLOAT Database::stdTX(const int i) const
 
 RFLOAT Database::stdTY(const int i) const
 {
+    if (_binary) return field(THU_STD_TRANSLATION_Y, i);
+
     fseek(_db, _offset[_reg[i]], SEEK_SET);
 
     char line[FILE_LINE_LENGTH];
@@ -456,6 +907,8 @@ RFLOAT Database::stdTY(const int i) const
 
 RFLOAT Database::d(const int i) const
 {
+    if (_binary) return field(THU_DEFOCUS_FACTOR, i);
+
     fseek(_db, _offset[_reg[i]], SEEK_SET);
 
     char line[FILE_LINE_LENGTH];
@@ -473,6 +926,8 @@ RFLOAT Database::d(const int i) const
 
 RFLOAT Database::stdD(const int i) const
 {
+    if (_binary) return field(THU_STD_DEFOCUS_FACTOR, i);
+
     fseek(_db, _offset[_reg[i]], SEEK_SET);
 
     char line[FILE_LINE_LENGTH];
@@ -490,6 +945,8 @@ RFLOAT Database::stdD(const int i) const
 
 RFLOAT Database::score(const int i) const
 {
+    if (_binary) return field(THU_SCORE, i);
+
     fseek(_db, _offset[_reg[i]], SEEK_SET);
 
     char line[FILE_LINE_LENGTH];
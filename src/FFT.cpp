@@ -12,6 +12,290 @@
 
 #include <omp_compat.h>
 
+#ifdef FFT_PLAN_CACHE
+
+/**
+ * a plan is valid for any arrays of the same size, direction and in-place-ness
+ * as long as the alignment of the arrays is the same as in planning
+ */
+struct FFTPlanKey
+{
+    int nCol;
+    int nRow;
+    int nSlc;
+    int nBatch;
+    int direction;
+    unsigned int nThread;
+    bool inPlace;
+    int alignR;
+    int alignC;
+
+    bool operator==(const FFTPlanKey& that) const
+    {
+        return (nCol == that.nCol)
+            && (nRow == that.nRow)
+            && (nSlc == that.nSlc)
+            && (nBatch == that.nBatch)
+            && (direction == that.direction)
+            && (nThread == that.nThread)
+            && (inPlace == that.inPlace)
+            && (alignR == that.alignR)
+            && (alignC == that.alignC);
+    }
+};
+
+struct FFTPlanEntry
+{
+    FFTPlanKey key;
+
+    TSFFTW_PLAN plan;
+};
+
+/**
+ * plans shared by the whole process, they live until the process exits
+ */
+static vector<FFTPlanEntry> planCache;
+
+/**
+ * plans looked up by the current thread, so that hitting the cache does not
+ * enter the critical section
+ */
+static thread_local vector<FFTPlanEntry> planCacheThread;
+
+static TSFFTW_PLAN createPlan(const FFTPlanKey& key)
+{
+    // plan on scratch arrays of the same alignment, as planning with
+    // FFT_PLAN_FLAG overwrites the arrays
+
+    size_t sizeR = (size_t)key.nCol * key.nRow * key.nSlc * key.nBatch * sizeof(RFLOAT);
+    size_t sizeC = (size_t)(key.nCol / 2 + 1) * key.nRow * key.nSlc * key.nBatch * sizeof(TSFFTW_COMPLEX);
+
+    char* bufR = (char*)TSFFTW_malloc((key.inPlace ? GSL_MAX(sizeR, sizeC) : sizeR) + 64);
+    char* bufC = key.inPlace ? bufR : (char*)TSFFTW_malloc(sizeC + 64);
+
+    RFLOAT* r = (RFLOAT*)(bufR + key.alignR);
+    TSFFTW_COMPLEX* c = (TSFFTW_COMPLEX*)(bufC + key.alignC);
+
+    TSFFTW_plan_with_nthreads(key.nThread);
+
+    TSFFTW_PLAN plan;
+
+    // a batch of images stored one after another
+    int n[2] = {key.nRow, key.nCol};
+
+    if (key.nBatch > 1)
+    {
+        if (key.direction == FFTW_FORWARD)
+            plan = TSFFTW_plan_many_dft_r2c(2,
+                                            n,
+                                            key.nBatch,
+                                            r,
+                                            key.nCol * key.nRow,
+                                            c,
+                                            (key.nCol / 2 + 1) * key.nRow,
+                                            FFT_PLAN_FLAG);
+        else
+            plan = TSFFTW_plan_many_dft_c2r(2,
+                                            n,
+                                            key.nBatch,
+                                            c,
+                                            (key.nCol / 2 + 1) * key.nRow,
+                                            r,
+                                            key.nCol * key.nRow,
+                                            FFT_PLAN_FLAG);
+    }
+    else if (key.direction == FFTW_FORWARD)
+    {
+        if (key.nSlc == 1)
+            plan = TSFFTW_plan_dft_r2c_2d(key.nRow, key.nCol, r, c, FFT_PLAN_FLAG);
+        else
+            plan = TSFFTW_plan_dft_r2c_3d(key.nRow, key.nCol, key.nSlc, r, c, FFT_PLAN_FLAG);
+    }
+    else
+    {
+        if (key.nSlc == 1)
+            plan = TSFFTW_plan_dft_c2r_2d(key.nRow, key.nCol, c, r, FFT_PLAN_FLAG);
+        else
+            plan = TSFFTW_plan_dft_c2r_3d(key.nRow, key.nCol, key.nSlc, c, r, FFT_PLAN_FLAG);
+    }
+
+    TSFFTW_plan_with_nthreads(1);
+
+    TSFFTW_free(bufR);
+    if (!key.inPlace) TSFFTW_free(bufC);
+
+    if (plan == NULL)
+    {
+        REPORT_ERROR("FAIL TO CREATE FFTW PLAN");
+        abort();
+    }
+
+    return plan;
+}
+
+static TSFFTW_PLAN cachedPlan(const int direction,
+                              const int nCol,
+                              const int nRow,
+                              const int nSlc,
+                              const unsigned int nThread,
+                              RFLOAT* r,
+                              TSFFTW_COMPLEX* c,
+                              const int nBatch = 1)
+{
+    FFTPlanKey key;
+
+    key.nCol = nCol;
+    key.nRow = nRow;
+    key.nSlc = nSlc;
+    key.nBatch = nBatch;
+    key.direction = direction;
+    key.nThread = nThread;
+    key.inPlace = ((void*)r == (void*)c);
+    key.alignR = TSFFTW_alignment_of(r);
+    key.alignC = TSFFTW_alignment_of((RFLOAT*)c);
+
+    for (size_t i = 0; i < planCacheThread.size(); i++)
+        if (planCacheThread[i].key == key)
+            return planCacheThread[i].plan;
+
+    FFTPlanEntry entry;
+
+    entry.key = key;
+    entry.plan = NULL;
+
+    #pragma omp critical (FFTPlanCache)
+    {
+        for (size_t i = 0; i < planCache.size(); i++)
+            if (planCache[i].key == key)
+            {
+                entry.plan = planCache[i].plan;
+                break;
+            }
+
+        if (entry.plan == NULL)
+        {
+            entry.plan = createPlan(key);
+
+            planCache.push_back(entry);
+        }
+    }
+
+    planCacheThread.push_back(entry);
+
+    return entry.plan;
+}
+
+void FFT::fwBatch(Image* const* img,
+                  const int n,
+                  const unsigned int nThread)
+{
+    if (n == 0) return;
+
+    int nCol = img[0]->nColRL();
+    int nRow = img[0]->nRowRL();
+
+    size_t sizeR = (size_t)nCol * nRow;
+    size_t sizeC = (size_t)(nCol / 2 + 1) * nRow;
+
+    #pragma omp parallel num_threads(nThread)
+    {
+        RFLOAT* slabR = (RFLOAT*)TSFFTW_malloc(FFT_BATCH_SIZE * sizeR * sizeof(RFLOAT));
+        TSFFTW_COMPLEX* slabC = (TSFFTW_COMPLEX*)TSFFTW_malloc(FFT_BATCH_SIZE * sizeC * sizeof(TSFFTW_COMPLEX));
+
+        #pragma omp for schedule(dynamic)
+        for (int b = 0; b < n; b += FFT_BATCH_SIZE)
+        {
+            int nb = GSL_MIN_INT(FFT_BATCH_SIZE, n - b);
+
+            for (int i = 0; i < nb; i++)
+            {
+                memcpy(slabR + i * sizeR, img[b + i]->dataRL(), sizeR * sizeof(RFLOAT));
+
+                img[b + i]->clearRL();
+            }
+
+            TSFFTW_execute_dft_r2c(cachedPlan(FFTW_FORWARD, nCol, nRow, 1, 1, slabR, slabC, nb),
+                                   slabR,
+                                   slabC);
+
+            for (int i = 0; i < nb; i++)
+            {
+                img[b + i]->alloc(FT_SPACE);
+
+                memcpy(&(*img[b + i])[0], slabC + i * sizeC, sizeC * sizeof(Complex));
+            }
+        }
+
+        TSFFTW_free(slabR);
+        TSFFTW_free(slabC);
+    }
+}
+
+void FFT::bwBatch(Image* const* img,
+                  const int n,
+                  const unsigned int nThread)
+{
+    if (n == 0) return;
+
+    int nCol = img[0]->nColRL();
+    int nRow = img[0]->nRowRL();
+
+    size_t sizeR = (size_t)nCol * nRow;
+    size_t sizeC = (size_t)(nCol / 2 + 1) * nRow;
+
+    RFLOAT scale = 1.0 / sizeR;
+
+    #pragma omp parallel num_threads(nThread)
+    {
+        RFLOAT* slabR = (RFLOAT*)TSFFTW_malloc(FFT_BATCH_SIZE * sizeR * sizeof(RFLOAT));
+        TSFFTW_COMPLEX* slabC = (TSFFTW_COMPLEX*)TSFFTW_malloc(FFT_BATCH_SIZE * sizeC * sizeof(TSFFTW_COMPLEX));
+
+        #pragma omp for schedule(dynamic)
+        for (int b = 0; b < n; b += FFT_BATCH_SIZE)
+        {
+            int nb = GSL_MIN_INT(FFT_BATCH_SIZE, n - b);
+
+            for (int i = 0; i < nb; i++)
+            {
+                memcpy(slabC + i * sizeC, img[b + i]->dataFT(), sizeC * sizeof(Complex));
+
+                img[b + i]->clearFT();
+            }
+
+            TSFFTW_execute_dft_c2r(cachedPlan(FFTW_BACKWARD, nCol, nRow, 1, 1, slabR, slabC, nb),
+                                   slabC,
+                                   slabR);
+
+            for (int i = 0; i < nb; i++)
+            {
+                img[b + i]->alloc(RL_SPACE);
+
+                RFLOAT* dst = &(*img[b + i])(0);
+                const RFLOAT* src = slabR + i * sizeR;
+
+                // normalise while copying out
+                for (size_t j = 0; j < sizeR; j++)
+                    dst[j] = src[j] * scale;
+            }
+        }
+
+        TSFFTW_free(slabR);
+        TSFFTW_free(slabC);
+    }
+}
+
+#endif
+
+bool FFT::importWisdom(const char* filename)
+{
+    return TSFFTW_import_wisdom_from_filename(filename) != 0;
+}
+
+bool FFT::exportWisdom(const char* filename)
+{
+    return TSFFTW_export_wisdom_to_filename(filename) != 0;
+}
+
 FFT::FFT() : _srcR(NULL),
              _srcC(NULL),
              _dstR(NULL),
@@ -59,6 +343,14 @@ void FFT::fw(Volume& vol)
 {
     FW_EXTRACT_P(vol);
 
+#ifdef FFT_PLAN_CACHE
+    TSFFTW_execute_dft_r2c(cachedPlan(FFTW_FORWARD, vol.nColRL(), vol.nRowRL(), vol.nSlcRL(), 1, _srcR, _dstC),
+                           _srcR,
+                           _dstC);
+
+    _srcR = NULL;
+    _dstC = NULL;
+#else
     if (vol.nSlcRL() == 1)
     {
         #pragma omp critical  (line64)
@@ -82,12 +374,25 @@ void FFT::fw(Volume& vol)
     TSFFTW_execute(fwPlan);
 
     FW_CLEAN_UP;
+#endif
 }
 
 void FFT::bw(Volume& vol)
 {
     BW_EXTRACT_P(vol);
 
+#ifdef FFT_PLAN_CACHE
+    TSFFTW_execute_dft_c2r(cachedPlan(FFTW_BACKWARD, vol.nColRL(), vol.nRowRL(), vol.nSlcRL(), 1, _dstR, _srcC),
+                           _srcC,
+                           _dstR);
+
+    SCALE_RL(vol, 1.0 / vol.sizeRL());
+
+    _dstR = NULL;
+    _srcC = NULL;
+
+    vol.clearFT();
+#else
     if (vol.nSlcRL() == 1)
     {
         #pragma omp critical  (line92)
@@ -113,6 +418,7 @@ void FFT::bw(Volume& vol)
     SCALE_RL(vol, 1.0 / vol.sizeRL());
 
     BW_CLEAN_UP(vol);
+#endif
 }
 
 void FFT::fw(Image& img,
@@ -126,6 +432,14 @@ void FFT::fw(Image& img,
     ***/
     FW_EXTRACT_P(img);
 
+#ifdef FFT_PLAN_CACHE
+    TSFFTW_execute_dft_r2c(cachedPlan(FFTW_FORWARD, img.nColRL(), img.nRowRL(), 1, nThread, _srcR, _dstC),
+                           _srcR,
+                           _dstC);
+
+    _srcR = NULL;
+    _dstC = NULL;
+#else
     TSFFTW_plan_with_nthreads(nThread);
 
     fwPlan = TSFFTW_plan_dft_r2c_2d(img.nRowRL(),
@@ -139,6 +453,7 @@ void FFT::fw(Image& img,
     TSFFTW_execute(fwPlan);
 
     FW_CLEAN_UP_MT;
+#endif
 }
 
 void FFT::bw(Image& img,
@@ -152,6 +467,19 @@ void FFT::bw(Image& img,
     ***/
     BW_EXTRACT_P(img);
 
+#ifdef FFT_PLAN_CACHE
+    TSFFTW_execute_dft_c2r(cachedPlan(FFTW_BACKWARD, img.nColRL(), img.nRowRL(), 1, nThread, _dstR, _srcC),
+                           _srcC,
+                           _dstR);
+
+    #pragma omp parallel for num_threads(nThread) 
+    SCALE_RL(img, 1.0 / img.sizeRL());
+
+    _dstR = NULL;
+    _srcC = NULL;
+
+    img.clearFT();
+#else
     TSFFTW_plan_with_nthreads(nThread);
 
     bwPlan = TSFFTW_plan_dft_c2r_2d(img.nRowRL(),
@@ -168,6 +496,7 @@ void FFT::bw(Image& img,
     SCALE_RL(img, 1.0 / img.sizeRL());
 
     BW_CLEAN_UP_MT(img);
+#endif
 }
 
 void FFT::fw(Volume& vol,
@@ -175,6 +504,14 @@ void FFT::fw(Volume& vol,
 {
     FW_EXTRACT_P(vol);
 
+#ifdef FFT_PLAN_CACHE
+    TSFFTW_execute_dft_r2c(cachedPlan(FFTW_FORWARD, vol.nColRL(), vol.nRowRL(), vol.nSlcRL(), nThread, _srcR, _dstC),
+                           _srcR,
+                           _dstC);
+
+    _srcR = NULL;
+    _dstC = NULL;
+#else
     TSFFTW_plan_with_nthreads(nThread);
 
     if (vol.nSlcRL() == 1)
@@ -196,6 +533,7 @@ void FFT::fw(Volume& vol,
     TSFFTW_execute(fwPlan);
 
     FW_CLEAN_UP_MT;
+#endif
 }
 
 void FFT::bw(Volume& vol,
@@ -203,6 +541,19 @@ void FFT::bw(Volume& vol,
 {
     BW_EXTRACT_P(vol);
 
+#ifdef FFT_PLAN_CACHE
+    TSFFTW_execute_dft_c2r(cachedPlan(FFTW_BACKWARD, vol.nColRL(), vol.nRowRL(), vol.nSlcRL(), nThread, _dstR, _srcC),
+                           _srcC,
+                           _dstR);
+
+    #pragma omp parallel for num_threads(nThread) 
+    SCALE_RL(vol, 1.0 / vol.sizeRL());
+
+    _dstR = NULL;
+    _srcC = NULL;
+
+    vol.clearFT();
+#else
     TSFFTW_plan_with_nthreads(nThread);
 
     if (vol.nSlcRL() == 1)
@@ -227,6 +578,7 @@ void FFT::bw(Volume& vol,
     SCALE_RL(vol, 1.0 / vol.sizeRL());
 
     BW_CLEAN_UP_MT(vol);
+#endif
 }
 
 /*void FFT::fwCreatePlan(const int nCol,
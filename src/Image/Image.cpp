@@ -93,10 +93,18 @@ void Image::alloc(const int nCol,
 #endif
 
 #ifdef FFTW_PTR
+        if ((_slabFT != NULL) && (_slabSizeFT == _sizeFT))
+        {
+            // re-use the memory owned by the slab
+            _dataFT = _slabFT;
+        }
+        else
+        {
 #ifdef FFTW_PTR_THREAD_SAFETY
-        #pragma omp critical  (line99)
+            #pragma omp critical  (line99)
 #endif
-        _dataFT = (Complex*)TSFFTW_malloc(_sizeFT * sizeof(Complex));
+            _dataFT = (Complex*)TSFFTW_malloc(_sizeFT * sizeof(Complex));
+        }
 #endif
     }
 
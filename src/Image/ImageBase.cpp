@@ -15,6 +15,8 @@ ImageBase::ImageBase() : _sizeRL(0), _sizeFT(0)
 #ifdef FFTW_PTR
     _dataRL = NULL;
     _dataFT = NULL;
+    _slabFT = NULL;
+    _slabSizeFT = 0;
 #endif
 }
 
@@ -46,14 +48,22 @@ ImageBase::~ImageBase()
         _dataRL = NULL;
     }
 
-    if (_dataFT != NULL)
+    freeFT();
+#endif
+}
+
+void ImageBase::freeFT()
+{
+#ifdef FFTW_PTR
+    if ((_dataFT != NULL) && (_dataFT != _slabFT))
     {
 #ifdef FFTW_PTR_THREAD_SAFETY
         #pragma omp critical  (line54)
 #endif
         TSFFTW_free(_dataFT);
-        _dataFT = NULL;
     }
+
+    _dataFT = NULL;
 #endif
 }
 
@@ -67,6 +77,8 @@ void ImageBase::swap(ImageBase& that)
 #ifdef FFTW_PTR
     std::swap(_dataRL, that._dataRL);
     std::swap(_dataFT, that._dataFT);
+    std::swap(_slabFT, that._slabFT);
+    std::swap(_slabSizeFT, that._slabSizeFT);
 #endif
 
     std::swap(_sizeRL, that._sizeRL);
@@ -119,15 +131,7 @@ void ImageBase::clearFT()
 #endif
     
 #ifdef FFTW_PTR
-    if (_dataFT != NULL)
-    {
-#ifdef FFTW_PTR_THREAD_SAFETY
-        #pragma omp critical (line127)
-#endif
-        TSFFTW_free(_dataFT);
-
-        _dataFT = NULL;
-    }
+    freeFT();
 #endif
 }
 
@@ -165,6 +169,12 @@ void ImageBase::copyBase(ImageBase& other) const
 
     other._sizeFT = _sizeFT;
 
+#ifdef FFTW_PTR
+    // the copy owns its memory
+    other._slabFT = NULL;
+    other._slabSizeFT = 0;
+#endif
+
     if (_dataFT)
     {
 #ifdef CXX11_PTR
@@ -193,6 +203,50 @@ void ImageBase::copyBase(ImageBase& other) const
     }
 }
 
+void ImageBase::attachFT(Complex* block)
+{
+#ifdef FFTW_PTR
+    if (_slabFT == block) return;
+
+    if (_dataFT != NULL)
+    {
+        memcpy(block, _dataFT, _sizeFT * sizeof(Complex));
+
+        freeFT();
+
+        _dataFT = block;
+    }
+
+    _slabFT = block;
+    _slabSizeFT = _sizeFT;
+#endif
+}
+
+bool ImageBase::isAttachedFT(const Complex* block) const
+{
+#ifdef FFTW_PTR
+    return _slabFT == block;
+#else
+    return false;
+#endif
+}
+
+void ImageBase::mapFT(Complex* block)
+{
+#ifdef FFTW_PTR
+    freeFT();
+
+    _dataFT = block;
+
+    _slabFT = block;
+    _slabSizeFT = _sizeFT;
+#else
+    REPORT_ERROR("MAPPING FOURIER SPACE REQUIRES FFTW_PTR");
+
+    abort();
+#endif
+}
+
 ImageBase ImageBase::copyBase() const
 {
     ImageBase that;
@@ -10,7 +10,74 @@
 
 #include "ImageFile.h"
 
-ImageFile::ImageFile() : _file(NULL), _symmetryData(NULL) {}
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+void CAST_ROW(RFLOAT* dst, const char* src, const size_t n)
+{
+    size_t i = 0;
+
+#if defined(ENABLE_SIMD_256) || defined(ENABLE_SIMD_512)
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i v = _mm_loadl_epi64((const __m128i*)(src + i));
+        __m128i lo = _mm_cvtepi8_epi32(v);
+        __m128i hi = _mm_cvtepi8_epi32(_mm_srli_si128(v, 4));
+
+#ifdef SINGLE_PRECISION
+        _mm256_storeu_ps(dst + i, _mm256_cvtepi32_ps(_mm256_set_m128i(hi, lo)));
+#else
+        _mm256_storeu_pd(dst + i, _mm256_cvtepi32_pd(lo));
+        _mm256_storeu_pd(dst + i + 4, _mm256_cvtepi32_pd(hi));
+#endif
+    }
+#endif
+
+    for (; i < n; i++)
+        dst[i] = (RFLOAT)src[i];
+}
+
+void CAST_ROW(RFLOAT* dst, const unsigned char* src, const size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        dst[i] = (RFLOAT)src[i];
+}
+
+void CAST_ROW(RFLOAT* dst, const short* src, const size_t n)
+{
+    size_t i = 0;
+
+#if defined(ENABLE_SIMD_256) || defined(ENABLE_SIMD_512)
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i lo = _mm_cvtepi16_epi32(v);
+        __m128i hi = _mm_cvtepi16_epi32(_mm_srli_si128(v, 8));
+
+#ifdef SINGLE_PRECISION
+        _mm256_storeu_ps(dst + i, _mm256_cvtepi32_ps(_mm256_set_m128i(hi, lo)));
+#else
+        _mm256_storeu_pd(dst + i, _mm256_cvtepi32_pd(lo));
+        _mm256_storeu_pd(dst + i + 4, _mm256_cvtepi32_pd(hi));
+#endif
+    }
+#endif
+
+    for (; i < n; i++)
+        dst[i] = (RFLOAT)src[i];
+}
+
+void CAST_ROW(RFLOAT* dst, const float* src, const size_t n)
+{
+#ifdef SINGLE_PRECISION
+    memcpy(dst, src, n * sizeof(float));
+#else
+    for (size_t i = 0; i < n; i++)
+        dst[i] = (RFLOAT)src[i];
+#endif
+}
+
+ImageFile::ImageFile() : _file(NULL), _symmetryData(NULL), _map(NULL), _mapSize(0) {}
 
 ImageFile::ImageFile(const char* filename,
                      const char* option)
@@ -26,6 +93,14 @@ ImageFile::ImageFile(const char* filename,
     }
 
     _symmetryData = NULL;
+
+    _map = NULL;
+    _mapSize = 0;
+
+#ifdef IMAGE_FILE_MMAP
+    if ((strcmp(option, "rb") == 0) || (strcmp(option, "r") == 0))
+        mapFile();
+#endif
 }
 
 ImageFile::~ImageFile()
@@ -136,6 +211,121 @@ void ImageFile::readImage(Image& dst,
     }
 }
 
+void ImageFile::readImages(Image* const* dst,
+                           const int* iSlc,
+                           const int n)
+{
+    if (n == 0) return;
+
+    for (int i = 0; i < n; i++)
+    {
+        if (iSlc[i] < 0 || iSlc[i] >= nSlc())
+        {
+            REPORT_ERROR("INDEX OF SLICE IS OUT BOUNDARY.");
+            abort();
+        }
+
+        if ((i > 0) && (iSlc[i] < iSlc[i - 1]))
+        {
+            REPORT_ERROR("INDICES OF SLICES SHOULD BE IN ASCENDING ORDER.");
+            abort();
+        }
+    }
+
+    if ((mode() != 0) && (mode() != 1) && (mode() != 2))
+    {
+        REPORT_ERROR("UNSUPPORTED MRC MODE");
+        abort();
+    }
+
+    readSymmetryData();
+
+    if (_map != NULL)
+    {
+        for (int k = 0; k < n; k++)
+        {
+            dst[k]->alloc(nCol(), nRow(), RL_SPACE);
+
+            const char* src = static_cast<const char*>(slice(iSlc[k]));
+
+            switch (mode())
+            {
+                case 0: IMAGE_CAST<char>(src, *dst[k]); break;
+                case 1: IMAGE_CAST<short>((const short*)src, *dst[k]); break;
+                case 2: IMAGE_CAST<float>((const float*)src, *dst[k]); break;
+            }
+        }
+
+        return;
+    }
+
+    size_t sizeSlc = (size_t)nCol() * nRow() * BYTE_MODE(mode());
+
+    int maxRun = IMAGE_FILE_MAX_READ_SIZE / sizeSlc;
+    if (maxRun < 1) maxRun = 1;
+
+    if (maxRun > iSlc[n - 1] - iSlc[0] + 1) maxRun = iSlc[n - 1] - iSlc[0] + 1;
+
+    char* buf = new char[sizeSlc * maxRun];
+
+    int i = 0;
+
+    while (i < n)
+    {
+        // slices from iSlc[i] to iSlc[j - 1] form a contiguous run in file
+
+        int j = i + 1;
+
+        while ((j < n) &&
+               (iSlc[j] - iSlc[j - 1] <= 1) &&
+               (iSlc[j] - iSlc[i] < maxRun))
+            j++;
+
+        int nRun = iSlc[j - 1] - iSlc[i] + 1;
+
+        SKIP_HEAD(sizeSlc * iSlc[i]);
+
+        if (fread(buf, sizeSlc, nRun, _file) != (size_t)nRun)
+        {
+            REPORT_ERROR("FAIL TO READ IN AN IMAGE.");
+            abort();
+        }
+
+        for (int k = i; k < j; k++)
+        {
+            dst[k]->alloc(nCol(), nRow(), RL_SPACE);
+
+            const char* src = buf + sizeSlc * (iSlc[k] - iSlc[i]);
+
+            switch (mode())
+            {
+                case 0: IMAGE_CAST<char>(src, *dst[k]); break;
+                case 1: IMAGE_CAST<short>((const short*)src, *dst[k]); break;
+                case 2: IMAGE_CAST<float>((const float*)src, *dst[k]); break;
+            }
+        }
+
+        i = j;
+    }
+
+    delete[] buf;
+}
+
+const void* ImageFile::slice(const int iSlc) const
+{
+    if (_map == NULL) return NULL;
+
+    if (iSlc < 0 || iSlc >= nSlc())
+    {
+        REPORT_ERROR("INDEX OF SLICE IS OUT BOUNDARY.");
+        abort();
+    }
+
+    size_t size = (size_t)nCol() * nRow() * BYTE_MODE(mode());
+
+    return mapData(1024 + symmetryDataSize() + size * iSlc, size);
+}
+
 void ImageFile::readVolume(Volume& dst,
                            const char* fileType)
 {
@@ -169,6 +359,41 @@ void ImageFile::clear()
         delete[] _symmetryData;
         _symmetryData = NULL;
     }
+
+    if (_map != NULL)
+    {
+        munmap(_map, _mapSize);
+
+        _map = NULL;
+        _mapSize = 0;
+    }
+}
+
+void ImageFile::mapFile()
+{
+    struct stat st;
+
+    if ((fstat(fileno(_file), &st) != 0) || (st.st_size < 1024)) return;
+
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fileno(_file), 0);
+
+    // fall back to stdio if the file can not be mapped
+    if (map == MAP_FAILED) return;
+
+    _map = static_cast<char*>(map);
+    _mapSize = st.st_size;
+}
+
+const char* ImageFile::mapData(const size_t offset,
+                               const size_t size) const
+{
+    if (offset + size > _mapSize)
+    {
+        REPORT_ERROR("FAIL TO READ IN AN IMAGE.");
+        abort();
+    }
+
+    return _map + offset;
 }
 
 void ImageFile::fillMRCHeader(MRCHeader& header) const
@@ -210,12 +435,17 @@ void ImageFile::readMetaDataMRC()
 {
     if (_file == NULL) REPORT_ERROR("FILE NOT EXIST");
 
-    rewind(_file);
-
-    if (fread(&_MRCHeader, 1, 1024, _file) != 1024)
+    if (_map != NULL)
+        memcpy(&_MRCHeader, _map, 1024);
+    else
     {
-        REPORT_ERROR("FAIL TO READ IN MRC HEADER FILE.");
-        abort();
+        rewind(_file);
+
+        if (fread(&_MRCHeader, 1, 1024, _file) != 1024)
+        {
+            REPORT_ERROR("FAIL TO READ IN MRC HEADER FILE.");
+            abort();
+        }
     }
 
     _metaData.mode = _MRCHeader.mode;
@@ -229,7 +459,16 @@ void ImageFile::readMetaDataMRC()
 
 void ImageFile::readSymmetryData()
 {
-    if (symmetryDataSize() != 0)
+    if ((symmetryDataSize() != 0) && (_map != NULL))
+    {
+        if (_symmetryData == NULL)
+        {
+            _symmetryData = new char[symmetryDataSize()];
+
+            memcpy(_symmetryData, mapData(1024, symmetryDataSize()), symmetryDataSize());
+        }
+    }
+    else if (symmetryDataSize() != 0)
     {
         if (fseek(_file, 1024, 0) != 0)
         {
@@ -254,6 +493,22 @@ void ImageFile::readImageMRC(Image& dst,
 
 	dst.alloc(nCol(), nRow(), RL_SPACE);
 
+    if (_map != NULL)
+    {
+        // convert directly from the mapped file, without a staging buffer
+
+        const char* src = static_cast<const char*>(slice(iSlc));
+
+        switch (mode())
+        {
+            case 0: IMAGE_CAST<char>(src, dst); break;
+            case 1: IMAGE_CAST<short>((const short*)src, dst); break;
+            case 2: IMAGE_CAST<float>((const float*)src, dst); break;
+        }
+
+        return;
+    }
+
     size_t size = dst.sizeRL();
 
     SKIP_HEAD(size * iSlc * BYTE_MODE(mode()));
@@ -298,6 +553,20 @@ void ImageFile::readVolumeMRC(Volume& dst)
 
 	dst.alloc(nCol(), nRow(), nSlc(), RL_SPACE);
 
+    if (_map != NULL)
+    {
+        const char* src = mapData(1024 + symmetryDataSize(), dst.sizeRL() * BYTE_MODE(mode()));
+
+        switch (mode())
+        {
+            case 0: VOLUME_CAST<char>(src, dst); break;
+            case 1: VOLUME_CAST<short>((const short*)src, dst); break;
+            case 2: VOLUME_CAST<float>((const float*)src, dst); break;
+        }
+
+        return;
+    }
+
     SKIP_HEAD(0);
 	
     switch (mode())
@@ -211,24 +211,55 @@ void translate(Image& dst,
     }
 }
 
-//void translate(Complex* dst,
-//               const RFLOAT nTransCol,
-//               const RFLOAT nTransRow,
-//               const int nCol,
-//               const int nRow,
-//               const int* iCol,
-//               const int* iRow,
-//               const int nPxl)
-//{
-//    RFLOAT rCol = nTransCol / nCol;
-//    RFLOAT rRow = nTransRow / nRow;
-//
-//    for (int i = 0; i < nPxl; i++)
-//    {
-//        RFLOAT phase = M_2X_PI * (iCol[i] * rCol + iRow[i] * rRow);
-//        dst[i] = COMPLEX_POLAR(-phase);
-//    }
-//}
+#ifdef IMAGE_TRANSLATE_SEPARABLE
+/**
+ * the phase tables of the calling thread, one for columns and one for rows
+ */
+static thread_local vector<Complex> translatePhaseTable[2];
+
+const Complex* translatePhase(const int dim,
+                              const RFLOAT nTrans,
+                              const int n)
+{
+    vector<Complex>& table = translatePhaseTable[dim];
+
+    table.resize(n + 1);
+
+    RFLOAT r = nTrans / n;
+
+    for (int i = -n / 2; i <= n / 2; i++)
+        table[i + n / 2] = COMPLEX_POLAR(-M_2X_PI * i * r);
+
+    return &table[n / 2];
+}
+#endif
+
+void translate(Complex* dst,
+               const RFLOAT nTransCol,
+               const RFLOAT nTransRow,
+               const int nCol,
+               const int nRow,
+               const int* iCol,
+               const int* iRow,
+               const int nPxl)
+{
+#ifdef IMAGE_TRANSLATE_SEPARABLE
+    const Complex* colP = translatePhase(0, nTransCol, nCol);
+    const Complex* rowP = translatePhase(1, nTransRow, nRow);
+
+    for (int i = 0; i < nPxl; i++)
+        dst[i] = colP[iCol[i]] * rowP[iRow[i]];
+#else
+    RFLOAT rCol = nTransCol / nCol;
+    RFLOAT rRow = nTransRow / nRow;
+
+    for (int i = 0; i < nPxl; i++)
+    {
+        RFLOAT phase = M_2X_PI * (iCol[i] * rCol + iRow[i] * rRow);
+        dst[i] = COMPLEX_POLAR(-phase);
+    }
+#endif
+}
 
 void translate(Complex* dst,
                const RFLOAT nTransCol,
@@ -240,6 +271,21 @@ void translate(Complex* dst,
                const int nPxl,
                const unsigned int nThread)
 {
+    if (nThread == 1)
+    {
+        translate(dst, nTransCol, nTransRow, nCol, nRow, iCol, iRow, nPxl);
+
+        return;
+    }
+
+#ifdef IMAGE_TRANSLATE_SEPARABLE
+    const Complex* colP = translatePhase(0, nTransCol, nCol);
+    const Complex* rowP = translatePhase(1, nTransRow, nRow);
+
+    #pragma omp parallel for num_threads(nThread)
+    for (int i = 0; i < nPxl; i++)
+        dst[i] = colP[iCol[i]] * rowP[iRow[i]];
+#else
     RFLOAT rCol = nTransCol / nCol;
     RFLOAT rRow = nTransRow / nRow;
 
@@ -249,6 +295,7 @@ void translate(Complex* dst,
         RFLOAT phase = M_2X_PI * (iCol[i] * rCol + iRow[i] * rRow);
         dst[i] = COMPLEX_POLAR(-phase);
     }
+#endif
 }
 
 //void translate(Image& dst,
@@ -447,26 +494,34 @@ void translate(Image& dst,
     }
 }
 
-//void translate(Complex* dst,
-//               const Complex* src,
-//               const RFLOAT nTransCol,
-//               const RFLOAT nTransRow,
-//               const int nCol,
-//               const int nRow,
-//               const int* iCol,
-//               const int* iRow,
-//               const int nPxl)
-//{
-//    RFLOAT rCol = nTransCol / nCol;
-//    RFLOAT rRow = nTransRow / nRow;
-//
-//    for (int i = 0; i < nPxl; i++)
-//    {
-//        RFLOAT phase = M_2X_PI * (iCol[i] * rCol + iRow[i] * rRow);
-//
-//        dst[i] = src[i] * COMPLEX_POLAR(-phase);
-//    }
-//}
+void translate(Complex* dst,
+               const Complex* src,
+               const RFLOAT nTransCol,
+               const RFLOAT nTransRow,
+               const int nCol,
+               const int nRow,
+               const int* iCol,
+               const int* iRow,
+               const int nPxl)
+{
+#ifdef IMAGE_TRANSLATE_SEPARABLE
+    const Complex* colP = translatePhase(0, nTransCol, nCol);
+    const Complex* rowP = translatePhase(1, nTransRow, nRow);
+
+    for (int i = 0; i < nPxl; i++)
+        dst[i] = src[i] * colP[iCol[i]] * rowP[iRow[i]];
+#else
+    RFLOAT rCol = nTransCol / nCol;
+    RFLOAT rRow = nTransRow / nRow;
+
+    for (int i = 0; i < nPxl; i++)
+    {
+        RFLOAT phase = M_2X_PI * (iCol[i] * rCol + iRow[i] * rRow);
+
+        dst[i] = src[i] * COMPLEX_POLAR(-phase);
+    }
+#endif
+}
 
 void translate(Complex* dst,
                const Complex* src,
@@ -479,6 +534,21 @@ void translate(Complex* dst,
                const int nPxl,
                const unsigned int nThread)
 {
+    if (nThread == 1)
+    {
+        translate(dst, src, nTransCol, nTransRow, nCol, nRow, iCol, iRow, nPxl);
+
+        return;
+    }
+
+#ifdef IMAGE_TRANSLATE_SEPARABLE
+    const Complex* colP = translatePhase(0, nTransCol, nCol);
+    const Complex* rowP = translatePhase(1, nTransRow, nRow);
+
+    #pragma omp parallel for num_threads(nThread)
+    for (int i = 0; i < nPxl; i++)
+        dst[i] = src[i] * colP[iCol[i]] * rowP[iRow[i]];
+#else
     RFLOAT rCol = nTransCol / nCol;
     RFLOAT rRow = nTransRow / nRow;
 
@@ -489,6 +559,7 @@ void translate(Complex* dst,
 
         dst[i] = src[i] * COMPLEX_POLAR(-phase);
     }
+#endif
 }
 
 void crossCorrelation(Image& dst,
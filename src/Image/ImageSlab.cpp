@@ -0,0 +1,83 @@
+/*******************************************************************************
+ * Author: Mingxu Hu
+ * Dependency:
+ * Test:
+ * Execution:
+ * Description:
+ *
+ * Manual:
+ * ****************************************************************************/
+
+#include "ImageSlab.h"
+
+ImageSlab::ImageSlab() : _data(NULL), _nSlot(0), _stride(0), _sizeFT(0) {}
+
+ImageSlab::~ImageSlab()
+{
+    clear();
+}
+
+void ImageSlab::alloc(const size_t nSlot,
+                      const size_t sizeFT)
+{
+    clear();
+
+    _nSlot = nSlot;
+    _sizeFT = sizeFT;
+
+    size_t align = IMAGE_SLAB_ALIGN / sizeof(Complex);
+
+    _stride = (sizeFT + align - 1) / align * align;
+
+    _data = (Complex*)TSFFTW_malloc(_nSlot * _stride * sizeof(Complex));
+
+    if ((_nSlot > 0) && (_data == NULL))
+    {
+        REPORT_ERROR("FAIL TO ALLOCATE IMAGE SLAB");
+        abort();
+    }
+
+    // first touch
+
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < _nSlot; i++)
+        memset(slot(i), 0, _stride * sizeof(Complex));
+}
+
+void ImageSlab::clear()
+{
+    if (_data != NULL)
+    {
+        TSFFTW_free(_data);
+
+        _data = NULL;
+    }
+
+    _nSlot = 0;
+    _stride = 0;
+    _sizeFT = 0;
+}
+
+void ImageSlab::attach(vector<Image>& img,
+                       const size_t iSlot)
+{
+    if (iSlot + img.size() > _nSlot)
+    {
+        REPORT_ERROR("IMAGE SLAB IS TOO SMALL");
+        abort();
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < img.size(); i++)
+    {
+        if (img[i].isAttachedFT(slot(iSlot + i))) continue;
+
+        if (img[i].sizeFT() != _sizeFT)
+        {
+            REPORT_ERROR("SIZE OF IMAGE DOES NOT MATCH IMAGE SLAB");
+            abort();
+        }
+
+        img[i].attachFT(slot(iSlot + i));
+    }
+}
@@ -122,6 +122,25 @@ void Volume::alloc(const int nCol,
     initBox();
 }
 
+void Volume::mapFT(Complex* block,
+                   const int nCol,
+                   const int nRow,
+                   const int nSlc)
+{
+    clear();
+
+    _nCol = nCol;
+    _nRow = nRow;
+    _nSlc = nSlc;
+
+    _sizeRL = nCol * nRow * nSlc;
+    _sizeFT = (nCol / 2 + 1) * nRow * nSlc;
+
+    ImageBase::mapFT(block);
+
+    initBox();
+}
+
 RFLOAT Volume::getRL(const int iCol,
                      const int iRow,
                      const int iSlc) const
@@ -14,7 +14,7 @@ void loggerInit(const char *logFileFullName)
     el::Loggers::setDefaultConfigurations(conf, true);
 
     const char* loggerNames[] = {"LOGGER_SYS","LOGGER_INIT","LOGGER_ROUND","LOGGER_COMPARE",
-                                 "LOGGER_RECO","LOGGER_MPI","LOGGER_FFT", "LOGGER_GPU", "LOGGER_MEM"};
+                                 "LOGGER_RECO","LOGGER_MPI","LOGGER_FFT", "LOGGER_GPU", "LOGGER_MEM", "LOGGER_PROF"};
     for (size_t i = 0; i < sizeof(loggerNames) / sizeof(*loggerNames); ++i)
     {
         el::Loggers::getLogger(loggerNames[i]); // Force creation of loggers
@@ -54,7 +54,7 @@ void loggerInit(int argc, const char* const * argv)
     el::Loggers::setDefaultConfigurations(conf, true);
 
     const char* loggerNames[] = {"LOGGER_SYS","LOGGER_INIT","LOGGER_ROUND","LOGGER_COMPARE",
-                                 "LOGGER_RECO","LOGGER_MPI","LOGGER_FFT", "LOGGER_GPU", "LOGGER_MEM"};
+                                 "LOGGER_RECO","LOGGER_MPI","LOGGER_FFT", "LOGGER_GPU", "LOGGER_MEM", "LOGGER_PROF"};
     for (size_t i = 0; i < sizeof(loggerNames) / sizeof(*loggerNames); ++i) {
         el::Loggers::getLogger(loggerNames[i]); // Force creation of loggers
     }
@@ -309,6 +309,19 @@ void Model::compareTwoHemispheres(const bool fscFlag,
                                   const RFLOAT thres,
                                   const unsigned int nThread)
 {
+    PROFILE_SCOPE("compareTwoHemispheres");
+
+#ifdef MODEL_DISTRIBUTED_COMPARE
+    // FSC of masked references needs the whole references in real space
+
+    if (!(fscFlag && (_maskFSC || _coreFSC) && (_mode == MODE_3D)))
+    {
+        compareTwoHemispheresDistributed(fscFlag, avgFlag, thres, nThread);
+
+        return;
+    }
+#endif
+
     if (fscFlag)
     {
         MLOG(INFO, "LOGGER_COMPARE") << "Setting Size of _FSC";
@@ -803,6 +816,268 @@ void Model::compareTwoHemispheres(const bool fscFlag,
     }
 }
 
+#ifdef MODEL_DISTRIBUTED_COMPARE
+
+void Model::compareTwoHemispheresDistributed(const bool fscFlag,
+                                             const bool avgFlag,
+                                             const RFLOAT thres,
+                                             const unsigned int nThread)
+{
+    if (fscFlag) _FSC.resize(_rU, _k);
+
+    MLOG(INFO, "LOGGER_COMPARE") << "Comparing References of Hemisphere A and Hemisphere B Distributedly";
+
+    int nSlc = (_mode == MODE_2D) ? 1 : _size;
+    int nColFT = _size / 2 + 1;
+
+    size_t sliceSize = (size_t)nColFT * _size;
+
+    /***
+     * processes of the same rank in two hemispheres form a pair, the i-th pair
+     * holds slices in [sliceBegin(i), sliceBegin(i + 1))
+     */
+
+    int hemiRank = -1;
+    int hemiSize = 0;
+    int nPair = 0;
+
+    MPI_Comm pair = MPI_COMM_NULL;
+
+    NT_MASTER
+    {
+        MPI_Comm_rank(_hemi, &hemiRank);
+        MPI_Comm_size(_hemi, &hemiSize);
+
+        MPI_Allreduce(&hemiSize, &nPair, 1, MPI_INT, MPI_MIN, _slav);
+
+        MPI_Comm_split(_slav, hemiRank, isA() ? 0 : 1, &pair);
+    }
+
+    // the master joins no pair, leaving nPair as 0 and the partition empty
+
+    vector<int> sliceBegin(nPair + 1, 0);
+
+    if (nPair > 0)
+        for (int i = 0; i <= nPair; i++)
+            sliceBegin[i] = (int)((long)nSlc * i / nPair);
+
+    bool paired = (hemiRank >= 0) && (hemiRank < nPair);
+
+    int begin = paired ? sliceBegin[hemiRank] : 0;
+    int nSlcPair = paired ? sliceBegin[hemiRank + 1] - begin : 0;
+
+    MPI_Datatype sliceType;
+
+    MPI_Type_contiguous(sliceSize, TS_MPI_DOUBLE_COMPLEX, &sliceType);
+    MPI_Type_commit(&sliceType);
+
+    // slices of the other hemisphere of each reference
+
+    vector< vector<Complex> > peer(_k);
+
+    vector<MPI_Request> req(2 * _k, MPI_REQUEST_NULL);
+
+    bool exchange = paired && (nSlcPair > 0) && (fscFlag || avgFlag);
+
+    if (exchange)
+    {
+        FOR_EACH_CLASS
+            peer[l].resize(nSlcPair * sliceSize);
+
+        MPI_Irecv(&peer[0][0], nSlcPair, sliceType, isA() ? 1 : 0, 0, pair, &req[0]);
+        MPI_Isend(&_ref[0][begin * sliceSize], nSlcPair, sliceType, isA() ? 1 : 0, 0, pair, &req[1]);
+    }
+
+    vector<double> sum(3 * _rU * _k, 0);
+
+    FOR_EACH_CLASS
+    {
+        if (!exchange) break;
+
+        if (l + 1 < _k)
+        {
+            MPI_Irecv(&peer[l + 1][0], nSlcPair, sliceType, isA() ? 1 : 0, l + 1, pair, &req[2 * (l + 1)]);
+            MPI_Isend(&_ref[l + 1][begin * sliceSize], nSlcPair, sliceType, isA() ? 1 : 0, l + 1, pair, &req[2 * (l + 1) + 1]);
+        }
+
+        MPI_Waitall(2, &req[2 * l], MPI_STATUSES_IGNORE);
+
+#ifndef NAN_NO_CHECK
+        SEGMENT_NAN_CHECK_COMPLEX(&peer[l][0], peer[l].size());
+#endif
+
+        // only hemisphere A sums, as a pair holds the same slices twice
+
+        if (fscFlag && isA())
+        {
+            ALOG(INFO, "LOGGER_COMPARE") << "Summing Shells of FSC of Reference " << l;
+
+            double* vecS = &sum[3 * _rU * l];
+            double* vecA = vecS + _rU;
+            double* vecB = vecA + _rU;
+
+            const Complex* A = &_ref[l][begin * sliceSize];
+            const Complex* B = &peer[l][0];
+
+            for (int s = 0; s < nSlcPair; s++)
+            {
+                int k = (begin + s < (nSlc + 1) / 2) ? begin + s : begin + s - nSlc;
+
+                for (int jj = 0; jj < _size; jj++)
+                {
+                    int j = (jj < _size / 2) ? jj : jj - _size;
+
+                    size_t index = (s * _size + jj) * (size_t)nColFT;
+
+                    for (int i = 0; i < nColFT; i++)
+                    {
+                        int u = AROUND(NORM_3(i, j, k));
+
+                        if (u < _rU)
+                        {
+                            vecS[u] += REAL(A[index + i] * CONJUGATE(B[index + i]));
+                            vecA[u] += ABS2(A[index + i]);
+                            vecB[u] += ABS2(B[index + i]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    if (fscFlag)
+    {
+        MLOG(INFO, "LOGGER_COMPARE") << "All Reducing Shells of FSC";
+
+        MPI_Allreduce(MPI_IN_PLACE,
+                      &sum[0],
+                      sum.size(),
+                      MPI_DOUBLE,
+                      MPI_SUM,
+                      MPI_COMM_WORLD);
+
+        FOR_EACH_CLASS
+        {
+            const double* vecS = &sum[3 * _rU * l];
+            const double* vecA = vecS + _rU;
+            const double* vecB = vecA + _rU;
+
+            for (int i = 0; i < _rU; i++)
+            {
+                double AB = sqrt(vecA[i] * vecB[i]);
+
+                _FSC(i, l) = (AB == 0) ? 0 : vecS[i] / AB;
+            }
+        }
+    }
+
+    if (avgFlag)
+    {
+        MLOG(INFO, "LOGGER_COMPARE") << "Averaging A and B";
+
+        // squared radius below which A and B are averaged, all when negative
+
+        RFLOAT r2 = -1;
+
+        if ((_k == 1) && (_goldenStandard))
+        {
+            // When refining only one reference, use gold standard FSC.
+
+#ifndef MODEL_AVERAGE_TWO_HEMISPHERE
+#ifdef MODEL_RESOLUTION_BASE_AVERAGE
+            int r = resolutionP(thres, false);
+#else
+            int r = GSL_MIN_INT(AROUND(resA2P(1.0 / A_B_AVERAGE_THRES,
+                                              _size,
+                                              _pixelSize)),
+                                _r);
+#endif
+
+            MLOG(INFO, "LOGGER_COMPARE") << "Averaging A and B Below Resolution "
+                                         << 1.0 / resP2A(r, _size, _pixelSize)
+                                         << "(Angstrom)";
+
+            r2 = TSGSL_pow_2(r);
+#endif
+        }
+
+        // processes without a pair gather no slice
+
+        vector<int> count(hemiSize, 0);
+        vector<int> displ(hemiSize, 0);
+
+        for (int i = 0; i < GSL_MIN_INT(nPair, hemiSize); i++)
+        {
+            count[i] = sliceBegin[i + 1] - sliceBegin[i];
+            displ[i] = sliceBegin[i];
+        }
+
+        vector<MPI_Request> gatherReq(_k, MPI_REQUEST_NULL);
+
+        FOR_EACH_CLASS
+        {
+            if (exchange)
+            {
+                Complex* own = &_ref[l][begin * sliceSize];
+                const Complex* other = &peer[l][0];
+
+                #pragma omp parallel for num_threads(nThread)
+                for (int s = 0; s < nSlcPair; s++)
+                {
+                    int k = (begin + s < (nSlc + 1) / 2) ? begin + s : begin + s - nSlc;
+
+                    for (int jj = 0; jj < _size; jj++)
+                    {
+                        int j = (jj < _size / 2) ? jj : jj - _size;
+
+                        size_t index = (s * _size + jj) * (size_t)nColFT;
+
+                        for (int i = 0; i < nColFT; i++)
+                        {
+                            if ((r2 < 0) || (QUAD_3(i, j, k) < r2))
+                                own[index + i] = (own[index + i] + other[index + i]) / 2;
+#ifdef MODEL_SWAP_HEMISPHERE
+                            else
+                                own[index + i] = other[index + i];
+#endif
+                        }
+                    }
+                }
+
+                peer[l].clear();
+            }
+
+            NT_MASTER
+            {
+                ALOG(INFO, "LOGGER_COMPARE") << "Gathering Averaged Slices of Reference " << l;
+                BLOG(INFO, "LOGGER_COMPARE") << "Gathering Averaged Slices of Reference " << l;
+
+                MPI_Iallgatherv(MPI_IN_PLACE,
+                                0,
+                                MPI_DATATYPE_NULL,
+                                &_ref[l][0],
+                                &count[0],
+                                &displ[0],
+                                sliceType,
+                                _hemi,
+                                &gatherReq[l]);
+            }
+        }
+
+        MPI_Waitall(_k, &gatherReq[0], MPI_STATUSES_IGNORE);
+    }
+
+    MPI_Type_free(&sliceType);
+
+    if (pair != MPI_COMM_NULL) MPI_Comm_free(&pair);
+
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    MLOG(INFO, "LOGGER_COMPARE") << "References of Hemisphere A and Hemisphere B Compared";
+}
+
+#endif
+
 void Model::lowPassRef(const RFLOAT thres,
                        const RFLOAT ew,
                        const unsigned int nThread)
@@ -963,8 +1238,134 @@ void Model::setProjMaxRadius(const int maxRadius)
         _proj[l].setMaxRadius(maxRadius);
 }
 
+void Model::saveCheckpoint(Checkpoint& cp,
+                           const bool ref) const
+{
+    cp.put(_r);
+    cp.put(_rInit);
+    cp.put(_rU);
+    cp.put(_rPrev);
+    cp.put(_rUPrev);
+    cp.put(_rT);
+    cp.put(_res);
+    cp.put(_resT);
+    cp.put(_rGlobal);
+    cp.put(_rVari);
+    cp.put(_tVariS0);
+    cp.put(_tVariS1);
+    cp.put(_tVariS0Prev);
+    cp.put(_tVariS1Prev);
+    cp.put(_stdRVari);
+    cp.put(_stdTVariS0);
+    cp.put(_stdTVariS1);
+    cp.put(_fscArea);
+    cp.put(_fscAreaPrev);
+    cp.put(_rChange);
+    cp.put(_rChangePrev);
+    cp.put(_stdRChange);
+    cp.put(_stdRChangePrev);
+    cp.put(_nRChangeNoDecrease);
+    cp.put(_nTopResNoImprove);
+    cp.put(_searchType);
+    cp.put(_searchTypePrev);
+    cp.put(_increaseR);
+
+    cp.putMatrix(_FSC);
+    cp.putMatrix(_SNR);
+    cp.putMatrix(_tau);
+    cp.putMatrix(_sig);
+
+    cp.put(ref);
+
+    if (ref)
+    {
+        FOR_EACH_CLASS
+        {
+            cp.put(_ref[l].sizeFT());
+            cp.putArray(_ref[l].dataFT(), _ref[l].sizeFT());
+        }
+    }
+}
+
+void Model::loadCheckpoint(Checkpoint& cp)
+{
+    cp.get(_r);
+    cp.get(_rInit);
+    cp.get(_rU);
+    cp.get(_rPrev);
+    cp.get(_rUPrev);
+    cp.get(_rT);
+    cp.get(_res);
+    cp.get(_resT);
+    cp.get(_rGlobal);
+    cp.get(_rVari);
+    cp.get(_tVariS0);
+    cp.get(_tVariS1);
+    cp.get(_tVariS0Prev);
+    cp.get(_tVariS1Prev);
+    cp.get(_stdRVari);
+    cp.get(_stdTVariS0);
+    cp.get(_stdTVariS1);
+    cp.get(_fscArea);
+    cp.get(_fscAreaPrev);
+    cp.get(_rChange);
+    cp.get(_rChangePrev);
+    cp.get(_stdRChange);
+    cp.get(_stdRChangePrev);
+    cp.get(_nRChangeNoDecrease);
+    cp.get(_nTopResNoImprove);
+    cp.get(_searchType);
+    cp.get(_searchTypePrev);
+    cp.get(_increaseR);
+
+    cp.getMatrix(_FSC);
+    cp.getMatrix(_SNR);
+    cp.getMatrix(_tau);
+    cp.getMatrix(_sig);
+
+    bool ref;
+
+    cp.get(ref);
+
+    if (ref)
+    {
+        FOR_EACH_CLASS
+        {
+            size_t sizeFT;
+
+            cp.get(sizeFT);
+
+            if (sizeFT != _ref[l].sizeFT())
+            {
+                CLOG(FATAL, "LOGGER_SYS") << "Size of Reference "
+                                          << l
+                                          << " in Checkpoint is "
+                                          << sizeFT
+                                          << ", but "
+                                          << _ref[l].sizeFT()
+                                          << " is Expected";
+
+                abort();
+            }
+
+            cp.getArray(&_ref[l][0], sizeFT);
+        }
+    }
+}
+
 void Model::refreshProj(const unsigned int nThread)
 {
+    PROFILE_SCOPE("refreshProj");
+
+#ifdef MODEL_SHARED_PROJECTEE
+    if (_mode == MODE_3D)
+    {
+        refreshProjShared(nThread);
+
+        return;
+    }
+#endif
+
     FOR_EACH_CLASS
     {
         _proj[l].setPf(_pf);
@@ -996,6 +1397,79 @@ void Model::refreshProj(const unsigned int nThread)
     }
 }
 
+#ifdef MODEL_SHARED_PROJECTEE
+
+void Model::refreshProjShared(const unsigned int nThread)
+{
+    MPI_Comm node, leader;
+
+    MPI_Comm_Split_Node(_hemi, &node, &leader);
+
+    int nodeRank;
+
+    MPI_Comm_rank(node, &nodeRank);
+
+    int size = _size * _pf;
+
+    size_t sizeFT = (size_t)(size / 2 + 1) * size * size;
+
+    // no process of the node reads the projectees while they are refreshed
+
+    MPI_Sync_Shared_Node(_hemi);
+
+    Complex* shared = reinterpret_cast<Complex*>(MPI_Alloc_Shared_Node(_hemi, _k * sizeFT * sizeof(Complex)));
+
+    FOR_EACH_CLASS
+    {
+        _proj[l].setPf(_pf);
+
+        if (_searchType == SEARCH_TYPE_GLOBAL)
+            _proj[l].setInterp(INTERP_TYPE_GLOBAL);
+        else
+            _proj[l].setInterp(INTERP_TYPE_LOCAL);
+
+        _proj[l].setMode(MODE_3D);
+
+        if (nodeRank == 0)
+        {
+            _proj[l].setProjectee(_ref[l].copyVolume(), nThread);
+
+            if (_proj[l].projectee3D().sizeFT() != sizeFT)
+            {
+                REPORT_ERROR("WRONG SIZE OF PADDED PROJECTEE");
+
+                abort();
+            }
+
+            memcpy(shared + l * sizeFT,
+                   _proj[l].projectee3D().dataFT(),
+                   sizeFT * sizeof(Complex));
+        }
+    }
+
+    MPI_Sync_Shared_Node(_hemi);
+
+    FOR_EACH_CLASS
+    {
+        _proj[l].mapProjectee(shared + l * sizeFT, size);
+
+        _proj[l].setMaxRadius(_r);
+    }
+
+    int nodeSize;
+
+    MPI_Comm_size(node, &nodeSize);
+
+    ALOG(INFO, "LOGGER_SYS") << "Projectors Shared by "
+                             << nodeSize
+                             << " Processes of the Node";
+    BLOG(INFO, "LOGGER_SYS") << "Projectors Shared by "
+                             << nodeSize
+                             << " Processes of the Node";
+}
+
+#endif
+
 void Model::refreshReco()
 {
     ALOG(INFO, "LOGGER_SYS") << "Refreshing Reconstructor(s) with Frequency Upper Boundary : "
@@ -1052,6 +1526,8 @@ void Model::refreshReco()
 
 void Model::resetReco(const RFLOAT thres)
 {
+    PROFILE_SCOPE("resetReco");
+
     ALOG(INFO, "LOGGER_SYS") << "Resetting Reconstructor(s) with Frequency Upper Boundary : "
                              << _rU;
     BLOG(INFO, "LOGGER_SYS") << "Resetting Reconstructor(s) with Frequency Upper Boundary : "
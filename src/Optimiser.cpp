@@ -9,17 +9,27 @@
 
 #include "Optimiser.h"
 
-#ifdef ENABLE_SIMD_512
- RFLOAT* logDataVSPrior_m_n_huabin_SIMD512(Complex* dat, const Complex* pri, const RFLOAT* ctf, const RFLOAT* sigRcp, const int n, const int m, RFLOAT *SIMDResult);
- RFLOAT logDataVSPrior_m_huabin_SIMD512(Complex* dat, const Complex* pri, const RFLOAT* ctf, const RFLOAT* sigRcp, const int m);
-#else
-#ifdef ENABLE_SIMD_256
- RFLOAT* logDataVSPrior_m_n_huabin_SIMD256(Complex* dat, const Complex* pri, const RFLOAT* ctf, const RFLOAT* sigRcp, const int n, const int m, RFLOAT *SIMDResult);
- RFLOAT logDataVSPrior_m_huabin_SIMD256(Complex* dat, const Complex* pri, const RFLOAT* ctf, const RFLOAT* sigRcp, const int m);
-#else
-   RFLOAT logDataVSPrior_m_huabin(const Complex* dat, const Complex* pri, const RFLOAT* ctf, const RFLOAT* sigRcp, const int m);
-   RFLOAT*  logDataVSPrior_m_n_huabin(const Complex* dat, const Complex* pri, const RFLOAT* ctf, const RFLOAT* sigRcp, const int n, const int m, RFLOAT *result);
+#ifdef OPTIMISER_GLOBAL_SCAN_BLOCK
+void logDataVSPrior_m_n_t_huabin(RFLOAT* result, const Complex* dat, const Complex* priRot, const Complex* tra, const RFLOAT* ctf, const int* ctfIdx, const int ldCTF, const RFLOAT* sigRcp, const int* sigIdx, const int ldSig, const int n, const int ld, const int m, const int nT);
 #endif
+
+#ifdef OPTIMISER_CTF_DEDUP
+/**
+ * order of CTFAttr, images sharing all the CTF parameters share one CTF
+ */
+struct CTFAttrLess
+{
+    bool operator()(const CTFAttr& a, const CTFAttr& b) const
+    {
+        if (a.voltage != b.voltage) return a.voltage < b.voltage;
+        if (a.defocusU != b.defocusU) return a.defocusU < b.defocusU;
+        if (a.defocusV != b.defocusV) return a.defocusV < b.defocusV;
+        if (a.defocusTheta != b.defocusTheta) return a.defocusTheta < b.defocusTheta;
+        if (a.Cs != b.Cs) return a.Cs < b.Cs;
+        if (a.amplitudeContrast != b.amplitudeContrast) return a.amplitudeContrast < b.amplitudeContrast;
+        return a.phaseShift < b.phaseShift;
+    }
+};
 #endif
 
 void compareDVPVariable(vec& dvpHuabin, vec& dvpOrig, int processRank, int threadID, int n ,int m)
@@ -127,6 +137,7 @@ void Optimiser::setPara(const OptimiserPara& para)
 
 void Optimiser::init()
 {
+    PROFILE_SCOPE("init");
 
 #ifdef GPU_VERSION
     MLOG(INFO, "LOGGER_GPU") << "Setting Up GPU Devices for Each Process";
@@ -328,8 +339,21 @@ void Optimiser::init()
     MLOG(INFO, "LOGGER_INIT") << "Openning Database File";
     _db.openDatabase(_para.db);
 
-    MLOG(INFO, "LOGGER_INIT") << "Shuffling Particles";
-    _db.shuffle();
+    Checkpoint cp;
+
+    if (_para.resume)
+    {
+        MLOG(INFO, "LOGGER_INIT") << "Reading Checkpoint";
+
+        openCheckpoint(cp);
+
+        MLOG(INFO, "LOGGER_INIT") << "Resuming from Round " << _iter;
+    }
+    else
+    {
+        MLOG(INFO, "LOGGER_INIT") << "Shuffling Particles";
+        _db.shuffle();
+    }
 
     MLOG(INFO, "LOGGER_INIT") << "Assigning Particles to Each Process";
     _db.assign();
@@ -439,63 +463,68 @@ void Optimiser::init()
         BLOG(INFO, "LOGGER_INIT") << "CTFs Generated";
 #endif
 
-        ALOG(INFO, "LOGGER_INIT") << "Initialising Particle Filters";
-        BLOG(INFO, "LOGGER_INIT") << "Initialising Particle Filters";
+        // particle filters are restored from the checkpoint later
 
-        initParticles();
+        if (!_para.resume)
+        {
+            ALOG(INFO, "LOGGER_INIT") << "Initialising Particle Filters";
+            BLOG(INFO, "LOGGER_INIT") << "Initialising Particle Filters";
+
+            initParticles();
 
 #ifdef VERBOSE_LEVEL_1
-        MPI_Barrier(_hemi);
+            MPI_Barrier(_hemi);
 
-        ALOG(INFO, "LOGGER_INIT") << "Particle Filters Initialised";
-        BLOG(INFO, "LOGGER_INIT") << "Particle Filters Initialised";
+            ALOG(INFO, "LOGGER_INIT") << "Particle Filters Initialised";
+            BLOG(INFO, "LOGGER_INIT") << "Particle Filters Initialised";
 #endif
 
-        if (!_para.gSearch)
-        {
-            ALOG(INFO, "LOGGER_INIT") << "Loading Particle Filters";
-            BLOG(INFO, "LOGGER_INIT") << "Loading Particle Filters";
+            if (!_para.gSearch)
+            {
+                ALOG(INFO, "LOGGER_INIT") << "Loading Particle Filters";
+                BLOG(INFO, "LOGGER_INIT") << "Loading Particle Filters";
 
-            loadParticles();
+                loadParticles();
 
 #ifdef VERBOSE_LEVEL_1
-            MPI_Barrier(_hemi);
+                MPI_Barrier(_hemi);
 
-            ALOG(INFO, "LOGGER_INIT") << "Particle Filters Loaded";
-            BLOG(INFO, "LOGGER_INIT") << "Particle Filters Loaded";
+                ALOG(INFO, "LOGGER_INIT") << "Particle Filters Loaded";
+                BLOG(INFO, "LOGGER_INIT") << "Particle Filters Loaded";
 #endif
 
 #ifdef OPTIMISER_RECENTRE_IMAGE_EACH_ITERATION
 
-            ALOG(INFO, "LOGGER_INIT") << "Re-Centring Images";
-            BLOG(INFO, "LOGGER_INIT") << "Re-Centring Images";
+                ALOG(INFO, "LOGGER_INIT") << "Re-Centring Images";
+                BLOG(INFO, "LOGGER_INIT") << "Re-Centring Images";
 
-            reCentreImg();
+                reCentreImg();
 
 #ifdef VERBOSE_LEVEL_1
-            MPI_Barrier(_hemi);
+                MPI_Barrier(_hemi);
 
-            ALOG(INFO, "LOGGER_INIT") << "Images Re-Centred";
-            BLOG(INFO, "LOGGER_INIT") << "Images Re-Centred";
+                ALOG(INFO, "LOGGER_INIT") << "Images Re-Centred";
+                BLOG(INFO, "LOGGER_INIT") << "Images Re-Centred";
 #endif
 #endif
 
 #ifdef OPTIMISER_MASK_IMG
 
-            MLOG(INFO, "LOGGER_ROUND") << "Re-Masking Images";
+                MLOG(INFO, "LOGGER_ROUND") << "Re-Masking Images";
 #ifdef GPU_VERSION
-            reMaskImgG();
+                reMaskImgG();
 #else
-            reMaskImg();
+                reMaskImg();
 #endif
 
 #ifdef VERBOSE_LEVEL_1
-            MPI_Barrier(_hemi);
+                MPI_Barrier(_hemi);
 
-            ALOG(INFO, "LOGGER_INIT") << "Images Re-Masked";
-            BLOG(INFO, "LOGGER_INIT") << "Images Re-Masked";
+                ALOG(INFO, "LOGGER_INIT") << "Images Re-Masked";
+                BLOG(INFO, "LOGGER_INIT") << "Images Re-Masked";
 #endif
 #endif
+            }
         }
     }
 
@@ -509,6 +538,19 @@ void Optimiser::init()
     MLOG(INFO, "LOGGER_INIT") << "Information of Groups Broadcasted";
 #endif
 
+    if (_para.resume)
+    {
+        MLOG(INFO, "LOGGER_INIT") << "Restoring States from Checkpoint";
+
+        loadCheckpoint(cp);
+
+#ifdef VERBOSE_LEVEL_1
+        MPI_Barrier(MPI_COMM_WORLD);
+
+        MLOG(INFO, "LOGGER_INIT") << "States Restored from Checkpoint";
+#endif
+    }
+
     NT_MASTER
     {
         /***
@@ -520,17 +562,27 @@ void Optimiser::init()
 #endif
         ***/
 
-        MLOG(INFO, "LOGGER_ROUND") << "Solvent Flattening";
+        // references in the checkpoint are flattened already
 
-        if ((_para.globalMask) || (_searchType != SEARCH_TYPE_GLOBAL))
-            solventFlatten(_para.performMask);
-        else
-            solventFlatten(false);
+        if (!_para.resume)
+        {
+            MLOG(INFO, "LOGGER_ROUND") << "Solvent Flattening";
+
+            if ((_para.globalMask) || (_searchType != SEARCH_TYPE_GLOBAL))
+                solventFlatten(_para.performMask);
+            else
+                solventFlatten(false);
+        }
 
         ALOG(INFO, "LOGGER_INIT") << "Setting Up Projectors and Reconstructors of _model";
         BLOG(INFO, "LOGGER_INIT") << "Setting Up Projectors and Reconstructors of _model";
 
         _model.initProjReco(_para.nThreadsPerProcess);
+
+        // reconstructors are resized to _rU and weighted by _FSC as at the end
+        // of the round saved
+
+        if (_para.resume) _model.resetReco(_para.thresReportFSC);
     }
 
 #ifdef VERBOSE_LEVEL_1
@@ -539,7 +591,7 @@ void Optimiser::init()
     MLOG(INFO, "LOGGER_INIT") << "Projectors and Reconstructors Set Up";
 #endif
 
-    if (strcmp(_para.initModel, "") != 0)
+    if ((strcmp(_para.initModel, "") != 0) && (!_para.resume))
     {
         MLOG(INFO, "LOGGER_INIT") << "Re-balancing Intensity Scale";
 
@@ -571,6 +623,10 @@ void Optimiser::init()
 #endif
     }
 
+    // sigma is restored from the checkpoint
+
+    if (_para.resume) return;
+
     NT_MASTER
     {
         ALOG(INFO, "LOGGER_INIT") << "Estimating Initial Sigma";
@@ -634,6 +690,8 @@ void Optimiser::expectation()
 {
     IF_MASTER return;
 
+    PROFILE_SCOPE("expectation");
+
     int nPer = 0;
 
     ALOG(INFO, "LOGGER_ROUND") << "Allocating Space for Pre-calcuation in Expectation";
@@ -643,6 +701,8 @@ void Optimiser::expectation()
 
     if (_searchType == SEARCH_TYPE_GLOBAL)
     {
+        PROFILE_SCOPE("globalSearch");
+
         if (_searchType != SEARCH_TYPE_CTF)
             allocPreCal(true, true, false);
         else
@@ -730,8 +790,7 @@ void Optimiser::expectation()
                       _para.size,
                       _iCol,
                       _iRow,
-                      _nPxl,
-                      _para.nThreadsPerProcess);
+                      _nPxl);
         }
 
         mat wC = mat::Zero(_ID.size(), _para.k);
@@ -755,41 +814,117 @@ void Optimiser::expectation()
             baseLine[l] = GSL_NAN;
         }
 
+#ifdef OPTIMISER_GLOBAL_SCAN_MERGE_ROTATION
+        // weights of an image against all translations of a rotation, summed
+        // by a thread against their own maximum before being merged
+
+        RFLOAT* poolWTRot = (RFLOAT*)TSFFTW_malloc(nT * omp_get_max_threads() * sizeof(RFLOAT));
+#endif
+
         // t -> class
         // m -> rotation
         // n -> translation
         
         //Add by huabin
-        RFLOAT *poolSIMDResult = (RFLOAT *)TSFFTW_malloc(_ID.size() * omp_get_max_threads() * sizeof(RFLOAT));
-        Complex* poolPriRotP = (Complex*)TSFFTW_malloc(_nPxl * omp_get_max_threads() * sizeof(Complex));
+#ifdef OPTIMISER_GLOBAL_SCAN_BLOCK
+        size_t nSIMDResult = (size_t)nT * GLOBAL_SCAN_BLOCK_IMG;
+#else
+        size_t nSIMDResult = _ID.size();
+#endif
+
+        RFLOAT *poolSIMDResult = (RFLOAT *)TSFFTW_malloc(nSIMDResult * omp_get_max_threads() * sizeof(RFLOAT));
+#ifdef OPTIMISER_GLOBAL_SCAN_BATCH_PROJECT
+        size_t nPriRotP = (size_t)_nPxl * GLOBAL_SCAN_BATCH_ROT;
+#else
+        size_t nPriRotP = _nPxl;
+#endif
+
+        Complex* poolPriRotP = (Complex*)TSFFTW_malloc(nPriRotP * omp_get_max_threads() * sizeof(Complex));
+#ifndef OPTIMISER_GLOBAL_SCAN_BLOCK
         Complex* poolPriAllP = (Complex*)TSFFTW_malloc(_nPxl * omp_get_max_threads() * sizeof(Complex));
+#endif
 
         for (size_t t = 0; t < (size_t)_para.k; t++)
         {
+            // the scan over rotations and translations, aggregated over classes
+
+            PROFILE_SCOPE("scan");
+
+#ifdef OPTIMISER_GLOBAL_SCAN_BATCH_PROJECT
+            #pragma omp parallel for schedule(dynamic, GLOBAL_SCAN_BATCH_ROT) private(rot2D, rot3D)
+#else
             #pragma omp parallel for schedule(dynamic) private(rot2D, rot3D)
+#endif
             for (size_t m = 0; m < (size_t)nR; m++)
             {
+#ifdef OPTIMISER_GLOBAL_SCAN_BATCH_PROJECT
+                Complex* priRotBatchP = poolPriRotP + nPriRotP * omp_get_thread_num();
+
+                Complex* priRotP = priRotBatchP + _nPxl * (m % GLOBAL_SCAN_BATCH_ROT);
+#else
                 Complex* priRotP = poolPriRotP + _nPxl * omp_get_thread_num();
+#endif
 
+#ifndef OPTIMISER_GLOBAL_SCAN_BLOCK
                 Complex* priAllP = poolPriAllP + _nPxl * omp_get_thread_num();
+#endif
 
 
                 //Add by huabin
-                RFLOAT* SIMDResult = poolSIMDResult + omp_get_thread_num() * _ID.size();
+                RFLOAT* SIMDResult = poolSIMDResult + omp_get_thread_num() * nSIMDResult;
+
+#ifdef OPTIMISER_GLOBAL_SCAN_MERGE_ROTATION
+                RFLOAT* wTRot = poolWTRot + nT * omp_get_thread_num();
+#endif
 
                 // perform projection
 
+#ifdef OPTIMISER_GLOBAL_SCAN_BATCH_PROJECT
+                // chunks of the dynamic schedule start at multiples of
+                // GLOBAL_SCAN_BATCH_ROT and are run in order by one thread,
+                // thus the whole chunk is projected at its first rotation
+
+                if (m % GLOBAL_SCAN_BATCH_ROT == 0)
+                {
+                    int nM = GSL_MIN_INT(GLOBAL_SCAN_BATCH_ROT, nR - (int)m);
+
+                    if (_para.mode == MODE_2D)
+                    {
+                        dmat22 rot2DBatch[GLOBAL_SCAN_BATCH_ROT];
+
+                        for (int j = 0; j < nM; j++)
+                            par.rot(rot2DBatch[j], m + j);
+
+                        _model.proj(t).projectBatch(priRotBatchP, rot2DBatch, nM, _iCol, _iRow, _nPxl);
+                    }
+                    else if (_para.mode == MODE_3D)
+                    {
+                        dmat33 rot3DBatch[GLOBAL_SCAN_BATCH_ROT];
+
+                        for (int j = 0; j < nM; j++)
+                            par.rot(rot3DBatch[j], m + j);
+
+                        _model.proj(t).projectBatch(priRotBatchP, rot3DBatch, nM, _iCol, _iRow, _nPxl);
+                    }
+                    else
+                    {
+                        REPORT_ERROR("INEXISTENT MODE");
+
+                        abort();
+                    }
+                }
+#else
                 if (_para.mode == MODE_2D)
                 {
                     par.rot(rot2D, m);
 
-                    _model.proj(t).project(priRotP, rot2D, _iCol, _iRow, _nPxl, _para.nThreadsPerProcess);
+                    _model.proj(t).project(priRotP, rot2D, _iCol, _iRow, _nPxl);
                 }
                 else if (_para.mode == MODE_3D)
                 {
                     par.rot(rot3D, m);
 
-                    _model.proj(t).project(priRotP, rot3D, _iCol, _iRow, _nPxl, _para.nThreadsPerProcess);
+                    _model.proj(t).project(priRotP, rot3D, _iCol, _iRow, _nPxl);
                 }
                 else
                 {
@@ -797,112 +932,222 @@ void Optimiser::expectation()
 
                     abort();
                 }
+#endif
+
+#ifdef OPTIMISER_GLOBAL_SCAN_BLOCK
+                int blockSize = GLOBAL_SCAN_BLOCK_IMG;
+#else
+                int blockSize = (int)_ID.size();
+#endif
 
-                for (size_t n = 0; n < (size_t)nT; n++)
+                for (int b = 0; b < (int)_ID.size(); b += blockSize)
                 {
-                    for (int i = 0; i < _nPxl; i++)
-                        priAllP[i] = traP[_nPxl * n + i] * priRotP[i];
+                    int nb = GSL_MIN_INT(blockSize, (int)_ID.size() - b);
 
-                    // higher logDataVSPrior, higher probability
+#ifdef OPTIMISER_GLOBAL_SCAN_BLOCK
+                    // scan a block of images against all translations of this rotation
 
-                    //Add by huabin
-                    memset(SIMDResult, '\0', _ID.size() * sizeof(RFLOAT));
+                    memset(SIMDResult, '\0', nT * nb * sizeof(RFLOAT));
 
-#ifdef ENABLE_SIMD_512
-            RFLOAT* dvp = logDataVSPrior_m_n_huabin_SIMD512(_datP,
-                                             priAllP,
-                                             _ctfP,
-                                             _sigRcpP,
-                                             (int)_ID.size(),
-                                             _nPxl,
-                                             SIMDResult);
+                    logDataVSPrior_m_n_t_huabin(SIMDResult,
+                                                _datP + b,
+                                                priRotP,
+                                                traP,
+#ifdef OPTIMISER_CTF_DEDUP
+                                                _ctfP,
+                                                _ctfIdx + b,
+                                                _nCTF,
 #else
-#ifdef ENABLE_SIMD_256
-            RFLOAT* dvp = logDataVSPrior_m_n_huabin_SIMD256(_datP,
-                                             priAllP,
-                                             _ctfP,
-                                             _sigRcpP,
-                                             (int)_ID.size(),
-                                             _nPxl,
-                                             SIMDResult);
+                                                _ctfP + b,
+                                                NULL,
+                                                (int)_ID.size(),
+#endif
+#ifdef OPTIMISER_SIGMA_BY_GROUP
+                                                _sigRcpP,
+                                                _sigIdx + b,
+                                                _nSig,
 #else
-            RFLOAT* dvp = logDataVSPrior_m_n_huabin(_datP,
-                                             priAllP,
-                                             _ctfP,
-                                             _sigRcpP,
-                                             (int)_ID.size(),
-                                             _nPxl,
-                                             SIMDResult);
+                                                _sigRcpP + b,
+                                                NULL,
+                                                (int)_ID.size(),
 #endif
+                                                nb,
+                                                (int)_ID.size(),
+                                                _nPxl,
+                                                nT);
 #endif
 
+#ifdef OPTIMISER_GLOBAL_SCAN_MERGE_ROTATION
+                    // the lock of an image is taken once per rotation instead of once per translation
+
 #ifndef NAN_NO_CHECK
 
-           SEGMENT_NAN_CHECK(dvp, _ID.size());
+                    SEGMENT_NAN_CHECK(SIMDResult, (size_t)nT * nb);
 
 #endif
 
-                    FOR_EACH_2D_IMAGE
+                    for (ptrdiff_t l = b; l < b + nb; l++)
                     {
+                        RFLOAT top = SIMDResult[l - b];
+
+                        for (size_t n = 1; n < (size_t)nT; n++)
+                            top = GSL_MAX(top, SIMDResult[n * nb + l - b]);
+
+                        RFLOAT sR = 0;
+
+                        for (size_t n = 0; n < (size_t)nT; n++)
+                        {
+                            RFLOAT w = exp(SIMDResult[n * nb + l - b] - top);
+
+                            sR += w * _par[l].wT(n);
+
+                            wTRot[n] = w * _par[l].wR(m);
+                        }
+
                         omp_set_lock(&mtx[l]);
 
                         if (TSGSL_isnan(baseLine[l]))
-                            baseLine[l] = dvp[l];
-                        else
+                            baseLine[l] = top;
+                        else if (top > baseLine[l])
                         {
-                            if (dvp[l] > baseLine[l])
+                            RFLOAT nf = exp(baseLine[l] - top);
+
+                            wC.row(l) *= nf;
+
+                            for (int td = 0; td < _para.k; td++)
                             {
-                                RFLOAT offset = dvp[l] - baseLine[l];
+                                wR[td].row(l) *= nf;
+                                wT[td].row(l) *= nf;
+                            }
 
-                                RFLOAT nf = exp(-offset);
+                            baseLine[l] = top;
+                        }
 
-                                wC.row(l) *= nf;
+                        RFLOAT nf = exp(top - baseLine[l]);
 
-                                for (int td = 0; td < _para.k; td++)
-                                {
-                                    wR[td].row(l) *= nf;
-                                    wT[td].row(l) *= nf;
-                                }
+                        wC(l, t) += nf * sR * _par[l].wR(m);
 
-                                /***
-                                RFLOAT nf = exp(offset);
+                        wR[t](l, m) += nf * sR;
 
-                                if (TSGSL_isinf(nf))
-                                {
-                                    wC.row(l) = vec::Zero(_para.k).transpose();
-                                    wR.row(l) = vec::Zero(nR).transpose();
-                                    wT.row(l) = vec::Zero(nT).transpose();
-                                }
-                                else
+                        for (size_t n = 0; n < (size_t)nT; n++)
+                            wT[t](l, n) += nf * wTRot[n];
+
+                        omp_unset_lock(&mtx[l]);
+                    }
+#else
+                    for (size_t n = 0; n < (size_t)nT; n++)
+                    {
+#ifdef OPTIMISER_GLOBAL_SCAN_BLOCK
+                        RFLOAT* dvp = SIMDResult + n * nb;
+#else
+                        for (int i = 0; i < _nPxl; i++)
+                            priAllP[i] = traP[_nPxl * n + i] * priRotP[i];
+
+                        // higher logDataVSPrior, higher probability
+
+                        //Add by huabin
+                        memset(SIMDResult, '\0', _ID.size() * sizeof(RFLOAT));
+
+#ifdef ENABLE_SIMD_512
+                RFLOAT* dvp = logDataVSPrior_m_n_huabin_SIMD512(_datP,
+                                                 priAllP,
+                                                 _ctfP,
+                                                 _sigRcpP,
+                                                 (int)_ID.size(),
+                                                 _nPxl,
+                                                 SIMDResult);
+#else
+#ifdef ENABLE_SIMD_256
+                RFLOAT* dvp = logDataVSPrior_m_n_huabin_SIMD256(_datP,
+                                                 priAllP,
+                                                 _ctfP,
+                                                 _sigRcpP,
+                                                 (int)_ID.size(),
+                                                 _nPxl,
+                                                 SIMDResult);
+#else
+                RFLOAT* dvp = logDataVSPrior_m_n_huabin(_datP,
+                                                 priAllP,
+                                                 _ctfP,
+                                                 _sigRcpP,
+                                                 (int)_ID.size(),
+                                                 _nPxl,
+                                                 SIMDResult);
+#endif
+#endif
+#endif
+
+#ifndef NAN_NO_CHECK
+
+                        SEGMENT_NAN_CHECK(dvp, nb);
+
+#endif
+
+                        for (ptrdiff_t l = b; l < b + nb; l++)
+                        {
+                            RFLOAT dvpL = dvp[l - b];
+
+                            omp_set_lock(&mtx[l]);
+
+                            if (TSGSL_isnan(baseLine[l]))
+                                baseLine[l] = dvpL;
+                            else
+                            {
+                                if (dvpL > baseLine[l])
                                 {
-                                    wC.row(l) /= nf;
-                                    wR.row(l) /= nf;
-                                    wT.row(l) /= nf;
+                                    RFLOAT offset = dvpL - baseLine[l];
+
+                                    RFLOAT nf = exp(-offset);
+
+                                    wC.row(l) *= nf;
+
+                                    for (int td = 0; td < _para.k; td++)
+                                    {
+                                        wR[td].row(l) *= nf;
+                                        wT[td].row(l) *= nf;
+                                    }
+
+                                    /***
+                                    RFLOAT nf = exp(offset);
+
+                                    if (TSGSL_isinf(nf))
+                                    {
+                                        wC.row(l) = vec::Zero(_para.k).transpose();
+                                        wR.row(l) = vec::Zero(nR).transpose();
+                                        wT.row(l) = vec::Zero(nT).transpose();
+                                    }
+                                    else
+                                    {
+                                        wC.row(l) /= nf;
+                                        wR.row(l) /= nf;
+                                        wT.row(l) /= nf;
+                                    }
+                                    ***/
+
+                                    baseLine[l] += offset;
                                 }
-                                ***/
-
-                                baseLine[l] += offset;
                             }
-                        }
 
-                        RFLOAT w = exp(dvp[l] - baseLine[l]);
+                            RFLOAT w = exp(dvpL - baseLine[l]);
 
-                        /***
-                        wC(l, t) += w;
+                            /***
+                            wC(l, t) += w;
 
-                        wR(l, m) += w;
+                            wR(l, m) += w;
 
-                        wT(l, n) += w;
-                        ***/
+                            wT(l, n) += w;
+                            ***/
 
-                        wC(l, t) += w * (_par[l].wR(m) * _par[l].wT(n));
+                            wC(l, t) += w * (_par[l].wR(m) * _par[l].wT(n));
 
-                        wR[t](l, m) += w * _par[l].wT(n);
+                            wR[t](l, m) += w * _par[l].wT(n);
 
-                        wT[t](l, n) += w * _par[l].wR(m);
+                            wT[t](l, n) += w * _par[l].wR(m);
 
-                        omp_unset_lock(&mtx[l]);
+                            omp_unset_lock(&mtx[l]);
+                        }
                     }
+#endif
                 }
 
                 #pragma omp atomic
@@ -926,7 +1171,13 @@ void Optimiser::expectation()
 
         TSFFTW_free(poolSIMDResult);
         TSFFTW_free(poolPriRotP);
+#ifndef OPTIMISER_GLOBAL_SCAN_BLOCK
         TSFFTW_free(poolPriAllP);
+#endif
+
+#ifdef OPTIMISER_GLOBAL_SCAN_MERGE_ROTATION
+        TSFFTW_free(poolWTRot);
+#endif
 
         delete[] mtx;
         delete[] baseLine;
@@ -1148,6 +1399,8 @@ void Optimiser::expectation()
 
 #ifdef OPTIMISER_PARTICLE_FILTER
 
+    PROFILE_SCOPE("localSearch");
+
     if (_searchType != SEARCH_TYPE_CTF)
         allocPreCal(true, false, false);
     else
@@ -1233,55 +1486,54 @@ void Optimiser::expectation()
             double d;
             dvec2 t;
 
-            FOR_EACH_C(_par[l])
+            // the translations are shared by classes
+
+            Complex* traP = poolTraP + _par[l].nT() * _nPxl * omp_get_thread_num();
+
+            FOR_EACH_T(_par[l])
             {
-                _par[l].c(c, iC);
+                _par[l].t(t, iT);
 
-                Complex* traP = poolTraP + _par[l].nT() * _nPxl * omp_get_thread_num();
+                translate(traP + iT * _nPxl,
+                          t(0),
+                          t(1),
+                          _para.size,
+                          _para.size,
+                          _iCol,
+                          _iRow,
+                          _nPxl);
+            }
 
-                FOR_EACH_T(_par[l])
-                {
-                    _par[l].t(t, iT);
+            // the CTFs of defocus factors are shared by classes
 
-                    translate(traP + iT * _nPxl,
-                              t(0),
-                              t(1),
-                              _para.size,
-                              _para.size,
-                              _iCol,
-                              _iRow,
-                              _nPxl,
-                              _para.nThreadsPerProcess);
-                }
+            RFLOAT* ctfP = NULL;
 
-                RFLOAT* ctfP;
+            if (_searchType == SEARCH_TYPE_CTF)
+            {
+                ctfP = poolCtfP + _par[l].nD() * _nPxl * omp_get_thread_num();
 
-                if (_searchType == SEARCH_TYPE_CTF)
+                FOR_EACH_D(_par[l])
                 {
-                    ctfP = poolCtfP + _par[l].nD() * _nPxl * omp_get_thread_num();
-
-                    FOR_EACH_D(_par[l])
-                    {
-                        _par[l].d(d, iD);
+                    _par[l].d(d, iD);
 
-                        for (int i = 0; i < _nPxl; i++)
-                        {
-                            RFLOAT ki = _K1[l]
-                                      * _defocusP[l * _nPxl + i]
-                                      * d
-                                      * TSGSL_pow_2(_frequency[i])
-                                      + _K2[l]
-                                      * TSGSL_pow_4(_frequency[i])
-                                      - _ctfAttr[l].phaseShift;
-
-                            //ctfP[_nPxl * iD + i] = -w1 * TS_SIN(ki) + w2 * TS_COS(ki);
-                            ctfP[_nPxl * iD + i] = -TS_SQRT(1 - TSGSL_pow_2(_ctfAttr[l].amplitudeContrast))
-                                                 * TS_SIN(ki)
-                                                 + _ctfAttr[l].amplitudeContrast
-                                                 * TS_COS(ki);
-                        }
-                    }
+                    CTF(ctfP + _nPxl * iD,
+                        _ctfAttr[l].voltage,
+                        _ctfAttr[l].defocusU * d,
+                        _ctfAttr[l].defocusV * d,
+                        _ctfAttr[l].defocusTheta,
+                        _ctfAttr[l].Cs,
+                        _ctfAttr[l].amplitudeContrast,
+                        _ctfAttr[l].phaseShift,
+                        _frequency,
+                        _cos2Angle,
+                        _sin2Angle,
+                        _nPxl);
                 }
+            }
+
+            FOR_EACH_C(_par[l])
+            {
+                _par[l].c(c, iC);
 
                 FOR_EACH_R(_par[l])
                 {
@@ -1306,8 +1558,7 @@ void Optimiser::expectation()
                                                rot2D,
                                                _iCol,
                                                _iRow,
-                                               _nPxl,
-                                               _para.nThreadsPerProcess);
+                                               _nPxl);
                     }
                     else if (_para.mode == MODE_3D)
                     {
@@ -1315,8 +1566,7 @@ void Optimiser::expectation()
                                                rot3D,
                                                _iCol,
                                                _iRow,
-                                               _nPxl,
-                                               _para.nThreadsPerProcess);
+                                               _nPxl);
                     }
                     else
                     {
@@ -1341,8 +1591,8 @@ void Optimiser::expectation()
                             {
                                 w = logDataVSPrior_m_huabin_SIMD512(_datP + l * _nPxl,
                                                    priAllP,
-                                                   _ctfP + l * _nPxl,
-                                                   _sigRcpP + l * _nPxl,
+                                                   ctfRowP(l),
+                                                   sigRcpRowP(l),
                                                    _nPxl);
                             }
                             else
@@ -1350,7 +1600,7 @@ void Optimiser::expectation()
                                 w = logDataVSPrior_m_huabin_SIMD512(_datP + l * _nPxl,
                                                    priAllP,
                                                    ctfP + iD * _nPxl,
-                                                   _sigRcpP + l * _nPxl,
+                                                   sigRcpRowP(l),
                                                    _nPxl);
                             }
 #else
@@ -1359,8 +1609,8 @@ void Optimiser::expectation()
                             {
                                 w = logDataVSPrior_m_huabin_SIMD256(_datP + l * _nPxl,
                                                    priAllP,
-                                                   _ctfP + l * _nPxl,
-                                                   _sigRcpP + l * _nPxl,
+                                                   ctfRowP(l),
+                                                   sigRcpRowP(l),
                                                    _nPxl);
                             }
                             else
@@ -1368,7 +1618,7 @@ void Optimiser::expectation()
                                 w = logDataVSPrior_m_huabin_SIMD256(_datP + l * _nPxl,
                                                    priAllP,
                                                    ctfP + iD * _nPxl,
-                                                   _sigRcpP + l * _nPxl,
+                                                   sigRcpRowP(l),
                                                    _nPxl);
                             }
 #else
@@ -1376,8 +1626,8 @@ void Optimiser::expectation()
                             {
                                 w = logDataVSPrior_m_huabin(_datP + l * _nPxl,
                                                    priAllP,
-                                                   _ctfP + l * _nPxl,
-                                                   _sigRcpP + l * _nPxl,
+                                                   ctfRowP(l),
+                                                   sigRcpRowP(l),
                                                    _nPxl);
                             }
                             else
@@ -1385,7 +1635,7 @@ void Optimiser::expectation()
                                 w = logDataVSPrior_m_huabin(_datP + l * _nPxl,
                                                    priAllP,
                                                    ctfP + iD * _nPxl,
-                                                   _sigRcpP + l * _nPxl,
+                                                   sigRcpRowP(l),
                                                    _nPxl);
                             }
 #endif
@@ -1696,6 +1946,8 @@ void Optimiser::expectationG()
 {
     IF_MASTER return;
 
+    PROFILE_SCOPE("expectationG");
+
     int nPer = 0;
 
     ALOG(INFO, "LOGGER_ROUND") << "Allocating Space for Pre-calcuation in Expectation";
@@ -3415,6 +3667,8 @@ void Optimiser::expectationG()
 
 void Optimiser::maximization()
 {
+    PROFILE_SCOPE("maximization");
+
 #ifdef OPTIMISER_NORM_CORRECTION
     if ((_iter != 0) && (_searchType != SEARCH_TYPE_GLOBAL))
     {
@@ -3571,6 +3825,13 @@ void Optimiser::maximization()
 
 void Optimiser::run()
 {
+    if (_para.profile)
+    {
+        MLOG(INFO, "LOGGER_ROUND") << "Enabling Profiler";
+
+        Profiler::enable(_para.profileTrace, MPI_COMM_WORLD);
+    }
+
     MLOG(INFO, "LOGGER_ROUND") << "Initialising Optimiser";
 
     init();
@@ -3602,7 +3863,9 @@ void Optimiser::run()
 #endif
 
     MLOG(INFO, "LOGGER_ROUND") << "Entering Iteration";
-    for (_iter = 0; _iter < _para.iterMax; _iter++)
+    // _iter is set by init(), to 0 or to the round resumed from
+
+    for (; _iter < _para.iterMax; _iter++)
     {
         MLOG(INFO, "LOGGER_ROUND") << "Round " << _iter;
 
@@ -4080,6 +4343,20 @@ void Optimiser::run()
 
             _model.resetReco(_para.thresReportFSC);
         }
+
+        if ((_para.checkpointEach > 0) &&
+            ((_iter + 1) % _para.checkpointEach == 0))
+        {
+            MLOG(INFO, "LOGGER_ROUND") << "Saving Checkpoint";
+
+            saveCheckpoint();
+
+            MLOG(INFO, "LOGGER_ROUND") << "Checkpoint Saved";
+        }
+
+        // initialisation is reported along with the first round
+
+        Profiler::report(_iter, _para.dstPrefix, MPI_COMM_WORLD);
     }
 
     MLOG(INFO, "LOGGER_ROUND") << "Preparing to Reconstruct Reference(s) at Nyquist";
@@ -4178,6 +4455,10 @@ void Optimiser::run()
         FOR_EACH_2D_IMAGE
             _img.push_back(_imgOri[l].copyImage());
 
+#ifdef OPTIMISER_IMG_SLAB
+        attachImgSlab();
+#endif
+
 #ifdef OPTIMISER_MASK_IMG
         MLOG(INFO, "LOGGER_ROUND") << "Re-Masking Images";
 #ifdef GPU_VERSION
@@ -4371,6 +4652,10 @@ void Optimiser::run()
         MLOG(INFO, "LOGGER_ROUND") << "Database of Masked Region Reference Subtracted Images Saved";
 #endif
     }
+
+    // reconstruction at Nyquist is reported as the round after the last one
+
+    Profiler::report(_iter, _para.dstPrefix, MPI_COMM_WORLD);
 }
 
 void Optimiser::clear()
@@ -4632,53 +4917,156 @@ void Optimiser::initImg()
 
 #endif
 
-    string imgName;
+#ifdef OPTIMISER_READ_IMAGE_STACK
+    // file and index of slice of each image
+
+    vector<string> imgFile(_ID.size());
+    vector<int> imgSlc(_ID.size());
 
-    #pragma omp parallel for private(imgName)
     FOR_EACH_2D_IMAGE
     {
-        nImg += 1;
-
-        #pragma omp critical
-        if (nImg >= (int)_ID.size() / 10)
-        {
-            nPer += 1;
-
-            ALOG(INFO, "LOGGER_SYS") << nPer * 10 << "\% Percentage of Images Read";
-            BLOG(INFO, "LOGGER_SYS") << nPer * 10 << "\% Percentage of Images Read";
-
-            nImg = 0;
-        }
-
-        #pragma omp critical
-        imgName = _db.path(_ID[l]);
+        string imgName = _db.path(_ID[l]);
 
         if (imgName.find('@') == string::npos)
         {
-            ImageFile imf((string(_para.parPrefix) + imgName).c_str(), "rb");
-            imf.readMetaData();
-            imf.readImage(_img[l]);
+            imgFile[l] = string(_para.parPrefix) + imgName;
+            imgSlc[l] = 0;
         }
         else
         {
-            int nSlc = atoi(imgName.substr(0, imgName.find('@')).c_str()) - 1;
-            string filename = string(_para.parPrefix) + imgName.substr(imgName.find('@') + 1);
-
-            ImageFile imf(filename.c_str(), "rb");
-            imf.readMetaData();
-            imf.readImage(_img[l], nSlc);
+            imgFile[l] = string(_para.parPrefix) + imgName.substr(imgName.find('@') + 1);
+            imgSlc[l] = atoi(imgName.substr(0, imgName.find('@')).c_str()) - 1;
         }
+    }
 
-        if ((_img[l].nColRL() != _para.size) ||
-            (_img[l].nRowRL() != _para.size))
-        {
-            CLOG(FATAL, "LOGGER_SYS") << "Incorrect Size of 2D Images, "
-                                      << "Should be "
-                                      << _para.size
-                                      << " x "
-                                      << _para.size
-                                      << ", but "
-                                      << _img[l].nColRL()
+    // group images by stack, in ascending order of slices inside each stack
+
+    vector<int> order(_ID.size());
+
+    FOR_EACH_2D_IMAGE order[l] = l;
+
+    std::sort(order.begin(),
+              order.end(),
+              [&imgFile, &imgSlc](const int a, const int b)
+              {
+                  int c = imgFile[a].compare(imgFile[b]);
+
+                  return (c != 0) ? (c < 0) : (imgSlc[a] < imgSlc[b]);
+              });
+
+    vector<int> stackBegin;
+
+    FOR_EACH_2D_IMAGE
+        if ((l == 0) || (imgFile[order[l]] != imgFile[order[l - 1]]))
+            stackBegin.push_back(l);
+
+    stackBegin.push_back(_ID.size());
+
+    int nStack = stackBegin.size() - 1;
+
+    int nImgPer = (_ID.size() / 10 > 0) ? (_ID.size() / 10) : 1;
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int s = 0; s < nStack; s++)
+    {
+        int n = stackBegin[s + 1] - stackBegin[s];
+
+        vector<Image*> dst(n);
+        vector<int> slc(n);
+
+        for (int i = 0; i < n; i++)
+        {
+            dst[i] = &_img[order[stackBegin[s] + i]];
+            slc[i] = imgSlc[order[stackBegin[s] + i]];
+        }
+
+        ImageFile imf(imgFile[order[stackBegin[s]]].c_str(), "rb");
+        imf.readMetaData();
+        imf.readImages(&dst[0], &slc[0], n);
+
+        #pragma omp critical
+        {
+            nImg += n;
+
+            while (nImg >= nImgPer)
+            {
+                nPer += 1;
+
+                ALOG(INFO, "LOGGER_SYS") << nPer * 10 << "\% Percentage of Images Read";
+                BLOG(INFO, "LOGGER_SYS") << nPer * 10 << "\% Percentage of Images Read";
+
+                nImg -= nImgPer;
+            }
+        }
+    }
+
+    FOR_EACH_2D_IMAGE
+    {
+        if ((_img[l].nColRL() != _para.size) ||
+            (_img[l].nRowRL() != _para.size))
+        {
+            CLOG(FATAL, "LOGGER_SYS") << "Incorrect Size of 2D Images, "
+                                      << "Should be "
+                                      << _para.size
+                                      << " x "
+                                      << _para.size
+                                      << ", but "
+                                      << _img[l].nColRL()
+                                      << " x "
+                                      << _img[l].nRowRL()
+                                      << " Input.";
+
+            abort();
+        }
+    }
+#else
+    string imgName;
+
+    #pragma omp parallel for private(imgName)
+    FOR_EACH_2D_IMAGE
+    {
+        nImg += 1;
+
+        #pragma omp critical
+        if (nImg >= (int)_ID.size() / 10)
+        {
+            nPer += 1;
+
+            ALOG(INFO, "LOGGER_SYS") << nPer * 10 << "\% Percentage of Images Read";
+            BLOG(INFO, "LOGGER_SYS") << nPer * 10 << "\% Percentage of Images Read";
+
+            nImg = 0;
+        }
+
+        #pragma omp critical
+        imgName = _db.path(_ID[l]);
+
+        if (imgName.find('@') == string::npos)
+        {
+            ImageFile imf((string(_para.parPrefix) + imgName).c_str(), "rb");
+            imf.readMetaData();
+            imf.readImage(_img[l]);
+        }
+        else
+        {
+            int nSlc = atoi(imgName.substr(0, imgName.find('@')).c_str()) - 1;
+            string filename = string(_para.parPrefix) + imgName.substr(imgName.find('@') + 1);
+
+            ImageFile imf(filename.c_str(), "rb");
+            imf.readMetaData();
+            imf.readImage(_img[l], nSlc);
+        }
+
+        if ((_img[l].nColRL() != _para.size) ||
+            (_img[l].nRowRL() != _para.size))
+        {
+            CLOG(FATAL, "LOGGER_SYS") << "Incorrect Size of 2D Images, "
+                                      << "Should be "
+                                      << _para.size
+                                      << " x "
+                                      << _para.size
+                                      << ", but "
+                                      << _img[l].nColRL()
                                       << " x "
                                       << _img[l].nRowRL()
                                       << " Input.";
@@ -4686,6 +5074,7 @@ void Optimiser::initImg()
             abort();
         }
     }
+#endif
 
 #ifdef OPTIMISER_LOG_MEM_USAGE
     CHECK_MEMORY_USAGE("After Reading 2D Images");
@@ -4803,6 +5192,11 @@ void Optimiser::initImg()
     CHECK_MEMORY_USAGE("Before Performing Fourier Transform on 2D Images");
 #endif
 
+#ifdef OPTIMISER_IMG_SLAB
+    // Fourier transform writes into the slab directly
+    attachImgSlab();
+#endif
+
     fwImg();
 
 #ifdef OPTIMISER_LOG_MEM_USAGE
@@ -5026,6 +5420,17 @@ void Optimiser::normaliseImg()
 
 void Optimiser::fwImg()
 {
+#ifdef OPTIMISER_FFT_BATCH
+    vector<Image*> img(2 * _ID.size());
+
+    FOR_EACH_2D_IMAGE
+    {
+        img[2 * l] = &_img[l];
+        img[2 * l + 1] = &_imgOri[l];
+    }
+
+    if (!img.empty()) FFT::fwBatch(&img[0], img.size(), _para.nThreadsPerProcess);
+#else
     FOR_EACH_2D_IMAGE
     {
         _fftImg.fwExecutePlan(_img[l]);
@@ -5034,10 +5439,22 @@ void Optimiser::fwImg()
         _fftImg.fwExecutePlan(_imgOri[l]);
         _imgOri[l].clearRL();
     }
+#endif
 }
 
 void Optimiser::bwImg()
 {
+#ifdef OPTIMISER_FFT_BATCH
+    vector<Image*> img(2 * _ID.size());
+
+    FOR_EACH_2D_IMAGE
+    {
+        img[2 * l] = &_img[l];
+        img[2 * l + 1] = &_imgOri[l];
+    }
+
+    if (!img.empty()) FFT::bwBatch(&img[0], img.size(), _para.nThreadsPerProcess);
+#else
     FOR_EACH_2D_IMAGE
     {
         _fftImg.bwExecutePlan(_img[l], _para.nThreadsPerProcess);
@@ -5046,6 +5463,32 @@ void Optimiser::bwImg()
         _fftImg.bwExecutePlan(_imgOri[l], _para.nThreadsPerProcess);
         _imgOri[l].clearFT();
     }
+#endif
+}
+
+void Optimiser::attachImgSlab()
+{
+    IF_MASTER return;
+
+#ifdef OPTIMISER_IMG_SLAB
+    size_t n = _ID.size();
+
+    if (_imgSlab.nSlot() == 0)
+    {
+#ifdef OPTIMISER_CTF_ON_THE_FLY
+        _imgSlab.alloc(2 * n, (_para.size / 2 + 1) * _para.size);
+#else
+        _imgSlab.alloc(3 * n, (_para.size / 2 + 1) * _para.size);
+#endif
+    }
+
+    _imgSlab.attach(_img, 0);
+    _imgSlab.attach(_imgOri, n);
+
+#ifndef OPTIMISER_CTF_ON_THE_FLY
+    _imgSlab.attach(_ctf, 2 * n);
+#endif
+#endif
 }
 
 void Optimiser::initCTF()
@@ -5087,6 +5530,10 @@ void Optimiser::initCTF()
             _ctfAttr[l].amplitudeContrast,
             _ctfAttr[l].phaseShift);
     }
+
+#ifdef OPTIMISER_IMG_SLAB
+    attachImgSlab();
+#endif
 #endif
 }
 
@@ -5094,6 +5541,8 @@ void Optimiser::correctScale(const bool init,
                              const bool coord,
                              const bool group)
 {
+    PROFILE_SCOPE("correctScale");
+
     ALOG(INFO, "LOGGER_SYS") << "Refreshing Scale";
     BLOG(INFO, "LOGGER_SYS") << "Refreshing Scale";
 
@@ -6118,6 +6567,22 @@ void Optimiser::reMaskImg()
                  EDGE_WIDTH_RL,
                  _para.nThreadsPerProcess);
 
+#ifdef OPTIMISER_FFT_BATCH
+        vector<Image*> img(_ID.size());
+
+        FOR_EACH_2D_IMAGE img[l] = &_img[l];
+
+        if (!img.empty())
+        {
+            FFT::bwBatch(&img[0], img.size(), _para.nThreadsPerProcess);
+
+            #pragma omp parallel for
+            FOR_EACH_2D_IMAGE
+                MUL_RL(_img[l], mask);
+
+            FFT::fwBatch(&img[0], img.size(), _para.nThreadsPerProcess);
+        }
+#else
         FOR_EACH_2D_IMAGE
         {
             _fftImg.bwExecutePlan(_img[l], _para.nThreadsPerProcess);
@@ -6129,6 +6594,7 @@ void Optimiser::reMaskImg()
 
             _img[l].clearRL();
         }
+#endif
     }
     else
     {
@@ -6189,6 +6655,8 @@ void Optimiser::reMaskImgG()
 
 void Optimiser::normCorrection()
 {
+    PROFILE_SCOPE("normCorrection");
+
     RFLOAT rNorm = TSGSL_MIN_RFLOAT(_r, _model.resolutionP(0.75, false));
 
     vec norm = vec::Zero(_nPar);
@@ -6387,6 +6855,8 @@ void Optimiser::allReduceSigma(const bool mask,
 {
     IF_MASTER return;
 
+    PROFILE_SCOPE("allReduceSigma");
+
 #ifdef OPTIMISER_SIGMA_WHOLE_FREQUENCY
     int rSig = maxR();
 #else
@@ -6699,6 +7169,8 @@ void Optimiser::reconstructRef(const bool fscFlag,
                                const bool avgSave,
                                const bool finished)
 {
+    PROFILE_SCOPE("reconstructRef");
+
     FFT fft;
 
     ALOG(INFO, "LOGGER_ROUND") << "Allocating Space for Pre-calculation in Reconstruction";
@@ -7018,209 +7490,286 @@ void Optimiser::reconstructRef(const bool fscFlag,
         }
 
 #else
-        Complex* poolTransImgP = (Complex*)TSFFTW_malloc(_nPxl * omp_get_max_threads() * sizeof(Complex));
-
-        #pragma omp parallel for
-        FOR_EACH_2D_IMAGE
-        {
-            RFLOAT* ctf;
-
-            RFLOAT w;
+#ifdef OPTIMISER_INSERT_BATCH
+        if ((_para.mode == MODE_3D) && (_para.k == 1))
+        {
+            RFLOAT* w = (RFLOAT*)malloc(_ID.size() * sizeof(RFLOAT));
+            double* offS = (double*)malloc(_ID.size() * 2 * sizeof(double));
+            double* nr = (double*)malloc(_para.mReco * _ID.size() * 4 * sizeof(double));
+            double* nt = (double*)malloc(_para.mReco * _ID.size() * 2 * sizeof(double));
+            double* nd = (double*)malloc(_para.mReco * _ID.size() * sizeof(double));
+            CTFAttr* ctfaData = (CTFAttr*)malloc(_ID.size() * sizeof(CTFAttr));
 
-            if (_searchType != SEARCH_TYPE_STOP)
+            #pragma omp parallel for
+            FOR_EACH_2D_IMAGE
             {
-                // allow user change score when only performing a reconstruction without expectation
-                _par[l].calScore();
-            }
-
-            if ((_para.parGra) && (_para.k == 1))
-                w = _par[l].compressR();
-            else
-                w = 1;
+                if (_searchType != SEARCH_TYPE_STOP)
+                {
+                    // allow user change score when only performing a reconstruction without expectation
+                    _par[l].calScore();
+                }
 
-            w /= _para.mReco;
+                if (_para.parGra)
+                    w[l] = _par[l].compressR();
+                else
+                    w[l] = 1;
 
-            Complex* transImgP = poolTransImgP + _nPxl * omp_get_thread_num();
+                w[l] /= _para.mReco;
 
-            Complex* orignImgP = _datP + _nPxl * l;
+                if (cSearch) ctfaData[l] = _ctfAttr[l];
 
-            for (int m = 0; m < _para.mReco; m++)
-            {
-                size_t cls;
-                dvec4 quat;
-                dvec2 tran;
-                double d;
+                offS[l * 2] = _offset[l](0);
+                offS[l * 2 + 1] = _offset[l](1);
 
-                if (_para.mode == MODE_2D)
+                int shift = l * _para.mReco;
+                for (int m = 0; m < _para.mReco; m++)
                 {
+                    size_t cls;
+                    dvec4 quat;
+                    dvec2 tran;
+                    double d;
+
                     _par[l].rand(cls, quat, tran, d);
 
-                    dmat22 rot2D;
+                    nt[(shift + m) * 2] = tran(0);
+                    nt[(shift + m) * 2 + 1] = tran(1);
+                    nr[(shift + m) * 4] = quat(0);
+                    nr[(shift + m) * 4 + 1] = quat(1);
+                    nr[(shift + m) * 4 + 2] = quat(2);
+                    nr[(shift + m) * 4 + 3] = quat(3);
+                    nd[shift + m] = d;
+                }
+            }
 
-                    rotate2D(rot2D, dvec2(quat(0), quat(1)));
+            _model.reco(0).insertI(_datP, _ctfP, _ctfIdx, _sigP, _sigIdx, w, offS, nr,
+                                   nt, nd, ctfaData, _para.pixelSize,
+                                   cSearch, _para.pf, _para.mReco,
+                                   _para.size, _ID.size());
 
-#ifdef OPTIMISER_RECENTRE_IMAGE_EACH_ITERATION
-                    translate(transImgP,
-                              orignImgP,
-                              -(tran - _offset[l])(0),
-                              -(tran - _offset[l])(1),
-                              _para.size,
-                              _para.size,
-                              _iCol,
-                              _iRow,
-                              _nPxl,
-                              _para.nThreadsPerProcess);
+            free(w);
+            free(offS);
+            free(nr);
+            free(nt);
+            free(nd);
+            free(ctfaData);
+        }
+        else
+#endif
+        {
+            Complex* poolTransImgP = (Complex*)TSFFTW_malloc(_nPxl * omp_get_max_threads() * sizeof(Complex));
+
+#ifdef RECONSTRUCTOR_INSERT_SLAB
+            ptrdiff_t nInsertBlock = OPTIMISER_INSERT_BLOCK;
 #else
-                    translate(transImgP,
-                              orignImgP,
-                              -(tran)(0),
-                              -(tran)(1),
-                              _para.size,
-                              _para.size,
-                              _iCol,
-                              _iRow,
-                              _nPxl,
-                              _para.nThreadsPerProcess);
+            ptrdiff_t nInsertBlock = static_cast<ptrdiff_t>(_ID.size());
 #endif
 
-                    if (cSearch)
+            for (ptrdiff_t b = 0; b < static_cast<ptrdiff_t>(_ID.size()); b += nInsertBlock)
+            {
+                ptrdiff_t e = std::min(b + nInsertBlock, static_cast<ptrdiff_t>(_ID.size()));
+
+                #pragma omp parallel for
+                for (ptrdiff_t l = b; l < e; l++)
+                {
+                    RFLOAT* ctf;
+
+                    RFLOAT w;
+
+                    if (_searchType != SEARCH_TYPE_STOP)
                     {
-                        ctf = (RFLOAT*)TSFFTW_malloc(_nPxl * sizeof(RFLOAT));
-
-                        CTF(ctf,
-                            _para.pixelSize,
-                            _ctfAttr[l].voltage,
-                            _ctfAttr[l].defocusU * d,
-                            _ctfAttr[l].defocusV * d,
-                            _ctfAttr[l].defocusTheta,
-                            _ctfAttr[l].Cs,
-                            _ctfAttr[l].amplitudeContrast,
-                            _ctfAttr[l].phaseShift,
-                            _para.size,
-                            _para.size,
-                            _iCol,
-                            _iRow,
-                            _nPxl);
+                        // allow user change score when only performing a reconstruction without expectation
+                        _par[l].calScore();
                     }
+
+                    if ((_para.parGra) && (_para.k == 1))
+                        w = _par[l].compressR();
                     else
+                        w = 1;
+
+                    w /= _para.mReco;
+
+                    Complex* transImgP = poolTransImgP + _nPxl * omp_get_thread_num();
+
+                    Complex* orignImgP = _datP + _nPxl * l;
+
+                    for (int m = 0; m < _para.mReco; m++)
                     {
-                        ctf = _ctfP + _nPxl * l;
-                    }
+                        size_t cls;
+                        dvec4 quat;
+                        dvec2 tran;
+                        double d;
+
+                        if (_para.mode == MODE_2D)
+                        {
+                            _par[l].rand(cls, quat, tran, d);
+
+                            dmat22 rot2D;
+
+                            rotate2D(rot2D, dvec2(quat(0), quat(1)));
+
+#ifdef OPTIMISER_RECENTRE_IMAGE_EACH_ITERATION
+                            translate(transImgP,
+                                      orignImgP,
+                                      -(tran - _offset[l])(0),
+                                      -(tran - _offset[l])(1),
+                                      _para.size,
+                                      _para.size,
+                                      _iCol,
+                                      _iRow,
+                                      _nPxl);
+#else
+                            translate(transImgP,
+                                      orignImgP,
+                                      -(tran)(0),
+                                      -(tran)(1),
+                                      _para.size,
+                                      _para.size,
+                                      _iCol,
+                                      _iRow,
+                                      _nPxl);
+#endif
+
+                            if (cSearch)
+                            {
+                                ctf = (RFLOAT*)TSFFTW_malloc(_nPxl * sizeof(RFLOAT));
+
+                                CTF(ctf,
+                                    _ctfAttr[l].voltage,
+                                    _ctfAttr[l].defocusU * d,
+                                    _ctfAttr[l].defocusV * d,
+                                    _ctfAttr[l].defocusTheta,
+                                    _ctfAttr[l].Cs,
+                                    _ctfAttr[l].amplitudeContrast,
+                                    _ctfAttr[l].phaseShift,
+                                    _frequency,
+                                    _cos2Angle,
+                                    _sin2Angle,
+                                    _nPxl);
+                            }
+                            else
+                            {
+                                ctf = ctfRowP(l);
+                            }
 
 #ifdef OPTIMISER_RECONSTRUCT_SIGMA_REGULARISE
-                    vec sig = _sig.row(_groupID[l] - 1).transpose();
+                            vec sig = _sig.row(_groupID[l] - 1).transpose();
 
-                    _model.reco(cls).insertP(transImgP,
-                                             ctf,
-                                             rot2D,
-                                             w,
-                                             &sig);
+                            _model.reco(cls).insertP(transImgP,
+                                                     ctf,
+                                                     rot2D,
+                                                     w,
+                                                     &sig);
 #else
-                    _model.reco(cls).insertP(transImgP,
-                                             ctf,
-                                             rot2D,
-                                             w);
+                            _model.reco(cls).insertP(transImgP,
+                                                     ctf,
+                                                     rot2D,
+                                                     w);
 #endif
 
-                    if (cSearch) TSFFTW_free(ctf);
+                            if (cSearch) TSFFTW_free(ctf);
 
 #ifdef OPTIMISER_RECENTRE_IMAGE_EACH_ITERATION
-                    dvec2 dir = -rot2D * (tran - _offset[l]);
+                            dvec2 dir = -rot2D * (tran - _offset[l]);
 #else
-                    dvec2 dir = -rot2D * tran;
+                            dvec2 dir = -rot2D * tran;
 #endif
-                    _model.reco(cls).insertDir(dir);
-                }
+                            _model.reco(cls).insertDir(dir);
+                        }
 
-                else if (_para.mode == MODE_3D)
-                {
-                    _par[l].rand(cls, quat, tran, d);
+                        else if (_para.mode == MODE_3D)
+                        {
+                            _par[l].rand(cls, quat, tran, d);
 
-                    dmat33 rot3D;
+                            dmat33 rot3D;
 
-                    rotate3D(rot3D, quat);
+                            rotate3D(rot3D, quat);
                 
 #ifdef OPTIMISER_RECENTRE_IMAGE_EACH_ITERATION
-                    translate(transImgP,
-                              orignImgP,
-                              -(tran - _offset[l])(0),
-                              -(tran - _offset[l])(1),
-                              _para.size,
-                              _para.size,
-                              _iCol,
-                              _iRow,
-                              _nPxl,
-                              _para.nThreadsPerProcess);
+                            translate(transImgP,
+                                      orignImgP,
+                                      -(tran - _offset[l])(0),
+                                      -(tran - _offset[l])(1),
+                                      _para.size,
+                                      _para.size,
+                                      _iCol,
+                                      _iRow,
+                                      _nPxl);
 #else
-                    translate(transImgP,
-                              orignImgP,
-                              -(tran)(0),
-                              -(tran)(1),
-                              _para.size,
-                              _para.size,
-                              _iCol,
-                              _iRow,
-                              _nPxl,
-                              _para.nThreadsPerProcess);
-#endif
-
-                    if (cSearch)
-                    {
-                        ctf = (RFLOAT*)TSFFTW_malloc(_nPxl * sizeof(RFLOAT));
-
-                        CTF(ctf,
-                            _para.pixelSize,
-                            _ctfAttr[l].voltage,
-                            _ctfAttr[l].defocusU * d,
-                            _ctfAttr[l].defocusV * d,
-                            _ctfAttr[l].defocusTheta,
-                            _ctfAttr[l].Cs,
-                            _ctfAttr[l].amplitudeContrast,
-                            _ctfAttr[l].phaseShift,
-                            _para.size,
-                            _para.size,
-                            _iCol,
-                            _iRow,
-                            _nPxl);
-                    }
-                    else
-                    {
-                        ctf = _ctfP + _nPxl * l;
-                    }
+                            translate(transImgP,
+                                      orignImgP,
+                                      -(tran)(0),
+                                      -(tran)(1),
+                                      _para.size,
+                                      _para.size,
+                                      _iCol,
+                                      _iRow,
+                                      _nPxl);
+#endif
+
+                            if (cSearch)
+                            {
+                                ctf = (RFLOAT*)TSFFTW_malloc(_nPxl * sizeof(RFLOAT));
+
+                                CTF(ctf,
+                                    _ctfAttr[l].voltage,
+                                    _ctfAttr[l].defocusU * d,
+                                    _ctfAttr[l].defocusV * d,
+                                    _ctfAttr[l].defocusTheta,
+                                    _ctfAttr[l].Cs,
+                                    _ctfAttr[l].amplitudeContrast,
+                                    _ctfAttr[l].phaseShift,
+                                    _frequency,
+                                    _cos2Angle,
+                                    _sin2Angle,
+                                    _nPxl);
+                            }
+                            else
+                            {
+                                ctf = ctfRowP(l);
+                            }
 
 #ifdef OPTIMISER_RECONSTRUCT_SIGMA_REGULARISE
-                    vec sig = _sig.row(_groupID[l] - 1).transpose();
+                            vec sig = _sig.row(_groupID[l] - 1).transpose();
 
-                    _model.reco(cls).insertP(transImgP,
-                                             ctf,
-                                             rot3D,
-                                             w,
-                                             &sig);
+                            _model.reco(cls).insertP(transImgP,
+                                                     ctf,
+                                                     rot3D,
+                                                     w,
+                                                     &sig);
 #else
-                    _model.reco(cls).insertP(transImgP,
-                                             ctf,
-                                             rot3D,
-                                             w);
+                            _model.reco(cls).insertP(transImgP,
+                                                     ctf,
+                                                     rot3D,
+                                                     w);
 #endif
 
-                    if (cSearch) TSFFTW_free(ctf);
+                            if (cSearch) TSFFTW_free(ctf);
 
 #ifdef OPTIMISER_RECENTRE_IMAGE_EACH_ITERATION
-                    dvec3 dir = -rot3D * dvec3((tran - _offset[l])[0],
-                                           (tran - _offset[l])[1],
-                                           0);
+                            dvec3 dir = -rot3D * dvec3((tran - _offset[l])[0],
+                                                   (tran - _offset[l])[1],
+                                                   0);
 #else
-                    dvec3 dir = -rot3D * dvec3(tran[0], tran[1], 0);
+                            dvec3 dir = -rot3D * dvec3(tran[0], tran[1], 0);
 #endif
-                    _model.reco(cls).insertDir(dir);
-                }
-                else
-                {
-                    REPORT_ERROR("INEXISTENT MODE");
-
-                    abort();
+                            _model.reco(cls).insertDir(dir);
+                        }
+                        else
+                        {
+                            REPORT_ERROR("INEXISTENT MODE");
+
+                            abort();
+                        }
+                    }
                 }
+
+#ifdef RECONSTRUCTOR_INSERT_BUFFERED
+                for (int t = 0; t < _para.k; t++)
+                    _model.reco(t).flushInsertP();
+#endif
             }
+
+            TSFFTW_free(poolTransImgP);
         }
 #endif
 
@@ -7750,6 +8299,8 @@ void Optimiser::reconstructRef(const bool fscFlag,
 
 void Optimiser::solventFlatten(const bool mask)
 {
+    PROFILE_SCOPE("solventFlatten");
+
     if ((_searchType == SEARCH_TYPE_GLOBAL) && mask)
     {
         MLOG(WARNING, "LOGGER_ROUND") << "PERFORM REFERENCE MASKING DURING GLOBAL SEARCH. NOT RECOMMMENDED.";
@@ -8021,6 +8572,28 @@ void Optimiser::allocPreCalIdx(const RFLOAT rU,
             }
         }
     }
+
+    // per-pixel tables shared by the CTFs of all images
+
+    _frequency = (RFLOAT*)TSFFTW_malloc(_nPxl * sizeof(RFLOAT));
+
+    _cos2Angle = (RFLOAT*)TSFFTW_malloc(_nPxl * sizeof(RFLOAT));
+
+    _sin2Angle = (RFLOAT*)TSFFTW_malloc(_nPxl * sizeof(RFLOAT));
+
+    for (int i = 0; i < _nPxl; i++)
+    {
+        _frequency[i] = NORM(_iCol[i],
+                             _iRow[i])
+                      / _para.size
+                      / _para.pixelSize;
+
+        RFLOAT angle = atan2(_iRow[i],
+                             _iCol[i]);
+
+        _cos2Angle[i] = cos(2 * angle);
+        _sin2Angle[i] = sin(2 * angle);
+    }
 }
 
 void Optimiser::allocPreCal(const bool mask,
@@ -8031,19 +8604,63 @@ void Optimiser::allocPreCal(const bool mask,
 
     _datP = (Complex*)TSFFTW_malloc(_ID.size() * _nPxl * sizeof(Complex));
 
+#ifdef OPTIMISER_SIGMA_BY_GROUP
+    // the noise of an image only depends on its group, thus images of the
+    // same group share one row, only groups held by this process get a row
+
+    _sigIdx = new int[_ID.size()];
+
+    vector<int> sigRep;
+
+    std::map<int, int> sigMap;
+
+    FOR_EACH_2D_IMAGE
+    {
+        std::pair<std::map<int, int>::iterator, bool> it
+            = sigMap.insert(std::make_pair(_groupID[l] - 1, (int)sigRep.size()));
+
+        if (it.second) sigRep.push_back(_groupID[l] - 1);
+
+        _sigIdx[l] = it.first->second;
+    }
+
+    _nSig = sigRep.size();
+
+    _sigP = (RFLOAT*)TSFFTW_malloc((size_t)_nSig * _nPxl * sizeof(RFLOAT));
+
+    _sigRcpP = (RFLOAT*)TSFFTW_malloc((size_t)_nSig * _nPxl * sizeof(RFLOAT));
+
+    for (int g = 0; g < _nSig; g++)
+    {
+        for (int i = 0; i < _nPxl; i++)
+        {
+            _sigP[pixelMajor
+                ? ((size_t)i * _nSig + g)
+                : ((size_t)_nPxl * g + i)] = _sig(sigRep[g], _iSig[i]);
+
+            _sigRcpP[pixelMajor
+                   ? ((size_t)i * _nSig + g)
+                   : ((size_t)_nPxl * g + i)] = _sigRcp(sigRep[g], _iSig[i]);
+        }
+    }
+#else
     _sigP = (RFLOAT*)TSFFTW_malloc(_ID.size() * _nPxl * sizeof(RFLOAT));
 
     _sigRcpP = (RFLOAT*)TSFFTW_malloc(_ID.size() * _nPxl * sizeof(RFLOAT));
+#endif
 
     #pragma omp parallel for
     FOR_EACH_2D_IMAGE
     {
+        const Complex* img = mask ? _img[l].dataFT() : _imgOri[l].dataFT();
+
         for (int i = 0; i < _nPxl; i++)
         {
             _datP[pixelMajor
                 ? (i * _ID.size() + l)
-                : (_nPxl * l + i)] = mask ? _img[l].iGetFT(_iPxl[i]) : _imgOri[l].iGetFT(_iPxl[i]);
+                : (_nPxl * l + i)] = img[_iPxl[i]];
 
+#ifndef OPTIMISER_SIGMA_BY_GROUP
             _sigP[pixelMajor
                 ? (i * _ID.size() + l)
                 : (_nPxl * l + i)] = _sig(_groupID[l] - 1, _iSig[i]);
@@ -8051,25 +8668,64 @@ void Optimiser::allocPreCal(const bool mask,
             _sigRcpP[pixelMajor
                    ? (i * _ID.size() + l)
                    : (_nPxl * l + i)] = _sigRcp(_groupID[l] - 1, _iSig[i]);
+#endif
         }
     }
 
     if (!ctf)
     {
-        _ctfP = (RFLOAT*)TSFFTW_malloc(_ID.size() * _nPxl * sizeof(RFLOAT));
+#ifdef OPTIMISER_CTF_DEDUP
+        // images from the same micrograph share one CTF
+
+        _ctfIdx = new int[_ID.size()];
+
+        vector<int> ctfRep;
+
+        std::map<CTFAttr, int, CTFAttrLess> ctfMap;
+
+        FOR_EACH_2D_IMAGE
+        {
+            std::pair<std::map<CTFAttr, int, CTFAttrLess>::iterator, bool> it
+                = ctfMap.insert(std::make_pair(_ctfAttr[l], (int)ctfRep.size()));
+
+            if (it.second) ctfRep.push_back(l);
+
+            _ctfIdx[l] = it.first->second;
+        }
+
+        _nCTF = ctfRep.size();
+
+        ALOG(INFO, "LOGGER_ROUND") << _nCTF
+                                   << " Distinct CTF(s) among "
+                                   << _ID.size()
+                                   << " Images";
+        BLOG(INFO, "LOGGER_ROUND") << _nCTF
+                                   << " Distinct CTF(s) among "
+                                   << _ID.size()
+                                   << " Images";
+#else
+        _nCTF = _ID.size();
+#endif
+
+        _ctfP = (RFLOAT*)TSFFTW_malloc((size_t)_nCTF * _nPxl * sizeof(RFLOAT));
 
 #ifdef OPTIMISER_CTF_ON_THE_FLY
         RFLOAT* poolCTF = (RFLOAT*)TSFFTW_malloc(_nPxl * omp_get_max_threads() * sizeof(RFLOAT));
 #endif
 
         #pragma omp parallel for
-        FOR_EACH_2D_IMAGE
+        for (int c = 0; c < _nCTF; c++)
         {
+#ifdef OPTIMISER_CTF_DEDUP
+            int l = ctfRep[c];
+#else
+            int l = c;
+#endif
+
 #ifdef OPTIMISER_CTF_ON_THE_FLY
             RFLOAT* ctf = poolCTF + _nPxl * omp_get_thread_num();
 
             CTF(ctf,
-                _para.pixelSize,
                 _ctfAttr[l].voltage,
                 _ctfAttr[l].defocusU,
                 _ctfAttr[l].defocusV,
@@ -8077,24 +8733,23 @@ void Optimiser::allocPreCal(const bool mask,
                 _ctfAttr[l].Cs,
                 _ctfAttr[l].amplitudeContrast,
                 _ctfAttr[l].phaseShift,
-                _para.size,
-                _para.size,
-                _iCol,
-                _iRow,
+                _frequency,
+                _cos2Angle,
+                _sin2Angle,
                 _nPxl);
 
             for (int i = 0; i < _nPxl; i++)
             {
                 _ctfP[pixelMajor
-                    ? (i * _ID.size() + l)
-                    : (_nPxl * l + i)] = ctf[i];
+                    ? ((size_t)i * _nCTF + c)
+                    : ((size_t)_nPxl * c + i)] = ctf[i];
             }
 #else
             for (int i = 0; i < _nPxl; i++)
             {
                 _ctfP[pixelMajor
-                    ? (i * _ID.size() + l)
-                    : (_nPxl * l + i)] = REAL(_ctf[l].iGetFT(_iPxl[i]));
+                    ? ((size_t)i * _nCTF + c)
+                    : ((size_t)_nPxl * c + i)] = REAL(_ctf[l].iGetFT(_iPxl[i]));
             }
 #endif
         }
@@ -8103,11 +8758,9 @@ void Optimiser::allocPreCal(const bool mask,
         TSFFTW_free(poolCTF);
 #endif
     }
+#ifdef GPU_VERSION
     else
     {
-        _frequency = (RFLOAT*)TSFFTW_malloc(_nPxl * sizeof(RFLOAT));
-        //_frequency = new RFLOAT[_nPxl];
-
         _defocusP = (RFLOAT*)TSFFTW_malloc(_ID.size() * _nPxl * sizeof(RFLOAT));
         //_defocusP = new RFLOAT[_ID.size() * _nPxl];
 
@@ -8117,12 +8770,6 @@ void Optimiser::allocPreCal(const bool mask,
         _K2 = (RFLOAT*)TSFFTW_malloc(_ID.size() * sizeof(RFLOAT));
         //_K2 = new RFLOAT[_ID.size()];
 
-        for (int i = 0; i < _nPxl; i++)
-            _frequency[i] = NORM(_iCol[i],
-                                 _iRow[i])
-                          / _para.size
-                          / _para.pixelSize;
-
         #pragma omp parallel for
         FOR_EACH_2D_IMAGE
         {
@@ -8150,6 +8797,7 @@ void Optimiser::allocPreCal(const bool mask,
             _K2[l] = M_PI_2 * _ctfAttr[l].Cs * TSGSL_pow_3(lambda);
         }
     }
+#endif
 }
 
 void Optimiser::freePreCalIdx()
@@ -8163,6 +8811,10 @@ void Optimiser::freePreCalIdx()
 
     delete[] _iColPad;
     delete[] _iRowPad;
+
+    TSFFTW_free(_frequency);
+    TSFFTW_free(_cos2Angle);
+    TSFFTW_free(_sin2Angle);
 }
 
 void Optimiser::freePreCal(const bool ctf)
@@ -8173,6 +8825,11 @@ void Optimiser::freePreCal(const bool ctf)
     TSFFTW_free(_sigP);
     TSFFTW_free(_sigRcpP);
 
+#ifdef OPTIMISER_SIGMA_BY_GROUP
+    delete[] _sigIdx;
+    _sigIdx = NULL;
+#endif
+
     /***
     delete[] _datP;
     delete[] _ctfP;
@@ -8182,11 +8839,15 @@ void Optimiser::freePreCal(const bool ctf)
     if (!ctf)
     {
         TSFFTW_free(_ctfP);
+
+#ifdef OPTIMISER_CTF_DEDUP
+        delete[] _ctfIdx;
+        _ctfIdx = NULL;
+#endif
     }
+#ifdef GPU_VERSION
     else
     {
-        TSFFTW_free(_frequency);
-        //delete[] _frequency;
         TSFFTW_free(_defocusP);
         //delete[] _defocusP;
         TSFFTW_free(_K1);
@@ -8194,6 +8855,25 @@ void Optimiser::freePreCal(const bool ctf)
         //delete[] _K1;
         //delete[] _K2;
     }
+#endif
+}
+
+RFLOAT* Optimiser::ctfRowP(const int l) const
+{
+#ifdef OPTIMISER_CTF_DEDUP
+    return _ctfP + (size_t)_nPxl * _ctfIdx[l];
+#else
+    return _ctfP + (size_t)_nPxl * l;
+#endif
+}
+
+RFLOAT* Optimiser::sigRcpRowP(const int l) const
+{
+#ifdef OPTIMISER_SIGMA_BY_GROUP
+    return _sigRcpP + (size_t)_nPxl * _sigIdx[l];
+#else
+    return _sigRcpP + (size_t)_nPxl * l;
+#endif
 }
 
 void Optimiser::saveDatabase(const bool finished,
@@ -8201,6 +8881,8 @@ void Optimiser::saveDatabase(const bool finished,
 {
     IF_MASTER return;
 
+    PROFILE_SCOPE("saveDatabase");
+
     char filename[FILE_NAME_LENGTH];
 
     if (subtract)
@@ -8210,6 +8892,17 @@ void Optimiser::saveDatabase(const bool finished,
     else
         sprintf(filename, "%sMeta_Round_%03d.thu", _para.dstPrefix, _iter);
 
+    char* line = new char[FILE_LINE_LENGTH];
+
+#ifdef OPTIMISER_SAVE_DATABASE_BINARY
+    // the same particles are also saved in a binary database
+    vector<THURecord> records;
+#endif
+
+#ifdef OPTIMISER_SAVE_DATABASE_PARALLEL
+    // lines of this process, written concurrently with other processes
+    string buf;
+#else
     bool flag;
     MPI_Status status;
     
@@ -8219,6 +8912,7 @@ void Optimiser::saveDatabase(const bool finished,
     FILE* file = (_commRank == 1)
                ? fopen(filename, "w")
                : fopen(filename, "a");
+#endif
 
     size_t cls;
     dvec4 quat;
@@ -8264,7 +8958,8 @@ void Optimiser::saveDatabase(const bool finished,
                          l + _ID.size() * (i + 1) + 1,
                          _commRank);
 
-                fprintf(file,
+                snprintf(line,
+                         FILE_LINE_LENGTH,
                         "%18.9lf %18.9lf %18.9lf %18.9lf %18.9lf %18.9lf %18.9lf \
                          %s %s %18.9lf %18.9lf \
                          %6d %6lu \
@@ -8305,12 +9000,24 @@ void Optimiser::saveDatabase(const bool finished,
                          df,
                          s,
                          _par[l].compressR());                
+
+#ifdef OPTIMISER_SAVE_DATABASE_PARALLEL
+                buf.append(line);
+#else
+                fputs(line, file);
+#endif
+
+#ifdef OPTIMISER_SAVE_DATABASE_BINARY
+                records.push_back(THURecord());
+                Database::parseLine(records.back(), line);
+#endif
             }
 
         }
         else
         {
-            fprintf(file,
+            snprintf(line,
+                     FILE_LINE_LENGTH,
                     "%18.9lf %18.9lf %18.9lf %18.9lf %18.9lf %18.9lf %18.9lf \
                      %s %s %18.9lf %18.9lf \
                      %6d %6lu \
@@ -8351,14 +9058,223 @@ void Optimiser::saveDatabase(const bool finished,
                      df,
                      s,
                      _par[l].compressR());            
+
+#ifdef OPTIMISER_SAVE_DATABASE_PARALLEL
+            buf.append(line);
+#else
+            fputs(line, file);
+#endif
+
+#ifdef OPTIMISER_SAVE_DATABASE_BINARY
+            records.push_back(THURecord());
+            Database::parseLine(records.back(), line);
+#endif
         }
 
     }
 
+    delete[] line;
+
+#ifdef OPTIMISER_SAVE_DATABASE_PARALLEL
+    MPI_Write_Ordered_Large(filename, buf.data(), buf.size(), _slav);
+#else
     fclose(file);
 
     if (_commRank != _commSize - 1)
         MPI_Send(&flag, 1, MPI_C_BOOL, _commRank + 1, 0, MPI_COMM_WORLD);
+#endif
+
+#ifdef OPTIMISER_SAVE_DATABASE_BINARY
+    // replace the suffix .thu with .thb
+    filename[strlen(filename) - 1] = 'b';
+
+    Database::saveDatabaseBinary(filename, records, _slav);
+#endif
+}
+
+void Optimiser::saveCheckpoint() const
+{
+    PROFILE_SCOPE("saveCheckpoint");
+
+    Checkpoint cp;
+
+    cp.put(CHECKPOINT_VERSION);
+    cp.put(_commSize);
+
+    // resume from the next round
+
+    cp.put(_iter + 1);
+
+    cp.put(_searchType);
+    cp.put(_r);
+    cp.put(_resCutoff);
+    cp.put(_resReport);
+    cp.put(_genMask);
+
+    IF_MASTER cp.putVector(_db.reg());
+
+    // references are identical in a hemisphere, thus only saved by the leads
+
+    _model.saveCheckpoint(cp, (_commRank == HEMI_A_LEAD) || (_commRank == HEMI_B_LEAD));
+
+    NT_MASTER
+    {
+        cp.putVector(_ID);
+
+        cp.putMatrix(_svd);
+        cp.putMatrix(_sig);
+        cp.putMatrix(_sigRcp);
+        cp.putMatrix(_scale);
+        cp.putMatrix(_cDistr);
+
+        cp.put(_mean);
+        cp.put(_stdN);
+        cp.put(_stdD);
+        cp.put(_stdS);
+        cp.put(_stdStdN);
+
+#ifdef OPTIMISER_RECENTRE_IMAGE_EACH_ITERATION
+        // offsets are kept as raw doubles, as an Eigen vector is not trivially copyable
+
+        cp.put((size_t)_offset.size());
+
+        for (size_t i = 0; i < _offset.size(); i++)
+            cp.putArray(_offset[i].data(), 2);
+#endif
+
+        FOR_EACH_2D_IMAGE
+            _par[l].saveCheckpoint(cp);
+    }
+
+    char filename[FILE_NAME_LENGTH];
+
+    if (snprintf(filename, sizeof(filename), "%sCheckpoint.thc", _para.dstPrefix) >= (int)sizeof(filename))
+    {
+        REPORT_ERROR("TOO LONG PATH OF CHECKPOINT");
+
+        abort();
+    }
+
+    cp.write(filename, MPI_COMM_WORLD);
+}
+
+void Optimiser::openCheckpoint(Checkpoint& cp)
+{
+    char filename[FILE_NAME_LENGTH];
+
+    if (snprintf(filename, sizeof(filename), "%sCheckpoint.thc", _para.dstPrefix) >= (int)sizeof(filename))
+    {
+        REPORT_ERROR("TOO LONG PATH OF CHECKPOINT");
+
+        abort();
+    }
+
+    cp.read(filename, MPI_COMM_WORLD);
+
+    int version, commSize;
+
+    cp.get(version);
+    cp.get(commSize);
+
+    if ((version != CHECKPOINT_VERSION) || (commSize != _commSize))
+    {
+        CLOG(FATAL, "LOGGER_SYS") << "Checkpoint "
+                                  << filename
+                                  << " of Version "
+                                  << version
+                                  << " with "
+                                  << commSize
+                                  << " Processes Can Not be Resumed";
+
+        abort();
+    }
+
+    cp.get(_iter);
+    cp.get(_searchType);
+    cp.get(_r);
+    cp.get(_resCutoff);
+    cp.get(_resReport);
+    cp.get(_genMask);
+
+    vector<int> reg;
+
+    IF_MASTER cp.getVector(reg);
+
+    _db.shuffle(reg);
+}
+
+void Optimiser::loadCheckpoint(Checkpoint& cp)
+{
+    _model.loadCheckpoint(cp);
+
+    NT_MASTER
+    {
+        for (int t = 0; t < _para.k; t++)
+            MPI_Bcast_Large(&_model.ref(t)[0],
+                            _model.ref(t).sizeFT(),
+                            TS_MPI_DOUBLE_COMPLEX,
+                            0,
+                            _hemi);
+
+        vector<int> id;
+
+        cp.getVector(id);
+
+        if (id != _ID)
+        {
+            CLOG(FATAL, "LOGGER_SYS") << "Images Assigned to Process "
+                                      << _commRank
+                                      << " Differ from Those in Checkpoint";
+
+            abort();
+        }
+
+        cp.getMatrix(_svd);
+        cp.getMatrix(_sig);
+        cp.getMatrix(_sigRcp);
+        cp.getMatrix(_scale);
+        cp.getMatrix(_cDistr);
+
+        cp.get(_mean);
+        cp.get(_stdN);
+        cp.get(_stdD);
+        cp.get(_stdS);
+        cp.get(_stdStdN);
+
+#ifdef OPTIMISER_RECENTRE_IMAGE_EACH_ITERATION
+        size_t nOffset;
+
+        cp.get(nOffset);
+
+        _offset.resize(nOffset);
+
+        for (size_t i = 0; i < nOffset; i++)
+            cp.getArray(_offset[i].data(), 2);
+#endif
+
+        initParticles();
+
+        FOR_EACH_2D_IMAGE
+            _par[l].loadCheckpoint(cp);
+
+#ifdef OPTIMISER_RECENTRE_IMAGE_EACH_ITERATION
+        #pragma omp parallel for
+        FOR_EACH_2D_IMAGE
+            translate(_img[l],
+                      _imgOri[l],
+                      _offset[l](0),
+                      _offset[l](1),
+                      _para.nThreadsPerProcess);
+#endif
+
+#ifdef OPTIMISER_MASK_IMG
+#ifdef GPU_VERSION
+        reMaskImgG();
+#else
+        reMaskImg();
+#endif
+#endif
+    }
 }
 
 void Optimiser::saveSubtract()
@@ -8585,6 +9501,8 @@ void Optimiser::saveCTFs()
 
 void Optimiser::saveMapHalf(const bool finished)
 {
+    PROFILE_SCOPE("saveMapHalf");
+
     if ((_commRank != HEMI_A_LEAD) &&
         (_commRank != HEMI_B_LEAD))
         return;
@@ -8735,6 +9653,8 @@ void Optimiser::saveMapHalf(const bool finished)
 
 void Optimiser::saveMapJoin(const bool finished)
 {
+    PROFILE_SCOPE("saveMapJoin");
+
     FFT fft;
 
     ImageFile imf;
@@ -8899,6 +9819,8 @@ void Optimiser::saveFSC(const bool finished) const
 {
     NT_MASTER return;
 
+    PROFILE_SCOPE("saveFSC");
+
     char filename[FILE_NAME_LENGTH];
 
     if (finished)
@@ -9022,7 +9944,6 @@ void Optimiser::saveTau() const
 //Change by huabin doubleToRFLOAT
 RFLOAT logDataVSPrior_m_huabin(const Complex* dat, const Complex* pri, const RFLOAT* ctf, const RFLOAT* sigRcp, const int m)
 {
-
    RFLOAT result2 = 0.0;
    RFLOAT tmpReal = 0.0;
    RFLOAT tmpImag = 0.0;
@@ -9378,7 +10299,6 @@ RFLOAT SIMD256Double(Complex* dat, const Complex* pri, const RFLOAT* ctf, const
 #ifdef ENABLE_SIMD_256
 RFLOAT logDataVSPrior_m_huabin_SIMD256(Complex* dat, const Complex* pri, const RFLOAT* ctf, const RFLOAT* sigRcp, const int m)
 {
-
 #ifdef SINGLE_PRECISION
     return SIMD256Float(dat, pri, ctf, sigRcp, m);
 #else
@@ -9750,7 +10670,6 @@ RFLOAT SIMD512Double(Complex* dat, const Complex* pri, const RFLOAT* ctf, const
 #ifdef ENABLE_SIMD_512
 RFLOAT logDataVSPrior_m_huabin_SIMD512(Complex* dat, const Complex* pri, const RFLOAT* ctf, const RFLOAT* sigRcp, const int m)
 {
-
     #ifdef SINGLE_PRECISION
         return SIMD512Float(dat, pri, ctf, sigRcp, m);
     #else
@@ -9767,7 +10686,6 @@ RFLOAT logDataVSPrior_m_huabin_SIMD512(Complex* dat, const Complex* pri, const R
 RFLOAT* logDataVSPrior_m_n_huabin(const Complex* dat, const Complex* pri, const RFLOAT* ctf, const RFLOAT* sigRcp, const int n, const int m, RFLOAT *result)
 {
 
-
     //vec result2 = vec::Zero(n);
     RFLOAT *result2 = result;
     //memset(result2, '\0', _ID.size() * sizeof(RFLOAT));
@@ -9808,6 +10726,176 @@ RFLOAT* logDataVSPrior_m_n_huabin(const Complex* dat, const Complex* pri, const
     return result2;
 }
 
+#ifdef OPTIMISER_GLOBAL_SCAN_BLOCK
+
+/**
+ *  accumulate the contribution of one pixel of a block of n images against
+ *  one prior value, the images of this pixel are contiguous in dat, ctf and
+ *  sigRcp
+ */
+static inline void logDataVSPrior_row_huabin(RFLOAT* result, const Complex* dat, const Complex pri, const RFLOAT* ctf, const RFLOAT* sigRcp, const int n)
+{
+    int j = 0;
+
+#ifdef ENABLE_SIMD_512
+#ifdef SINGLE_PRECISION
+    __m512 priReal = _mm512_set1_ps(pri.dat[0]);
+    __m512 priImag = _mm512_set1_ps(pri.dat[1]);
+
+    for (; j <= (n - 16); j += 16)
+    {
+        __m512 ymm1 = _mm512_loadu_ps(ctf + j);
+        __m512 ymm2 = _mm512_set_ps(dat[j + 15].dat[0], dat[j + 14].dat[0], dat[j + 13].dat[0], dat[j + 12].dat[0],
+                                    dat[j + 11].dat[0], dat[j + 10].dat[0], dat[j + 9].dat[0], dat[j + 8].dat[0],
+                                    dat[j + 7].dat[0], dat[j + 6].dat[0], dat[j + 5].dat[0], dat[j + 4].dat[0],
+                                    dat[j + 3].dat[0], dat[j + 2].dat[0], dat[j + 1].dat[0], dat[j].dat[0]);
+        __m512 ymm3 = _mm512_set_ps(dat[j + 15].dat[1], dat[j + 14].dat[1], dat[j + 13].dat[1], dat[j + 12].dat[1],
+                                    dat[j + 11].dat[1], dat[j + 10].dat[1], dat[j + 9].dat[1], dat[j + 8].dat[1],
+                                    dat[j + 7].dat[1], dat[j + 6].dat[1], dat[j + 5].dat[1], dat[j + 4].dat[1],
+                                    dat[j + 3].dat[1], dat[j + 2].dat[1], dat[j + 1].dat[1], dat[j].dat[1]);
+
+        __m512 ymm4 = _mm512_sub_ps(ymm2, _mm512_mul_ps(ymm1, priReal));
+        __m512 ymm5 = _mm512_sub_ps(ymm3, _mm512_mul_ps(ymm1, priImag));
+
+        ymm4 = _mm512_add_ps(_mm512_mul_ps(ymm4, ymm4), _mm512_mul_ps(ymm5, ymm5));
+        ymm4 = _mm512_mul_ps(ymm4, _mm512_loadu_ps(sigRcp + j));
+
+        _mm512_storeu_ps(result + j, _mm512_add_ps(_mm512_loadu_ps(result + j), ymm4));
+    }
+#else
+    __m512d priReal = _mm512_set1_pd(pri.dat[0]);
+    __m512d priImag = _mm512_set1_pd(pri.dat[1]);
+
+    for (; j <= (n - 8); j += 8)
+    {
+        __m512d ymm1 = _mm512_loadu_pd(ctf + j);
+        __m512d ymm2 = _mm512_set_pd(dat[j + 7].dat[0], dat[j + 6].dat[0], dat[j + 5].dat[0], dat[j + 4].dat[0],
+                                     dat[j + 3].dat[0], dat[j + 2].dat[0], dat[j + 1].dat[0], dat[j].dat[0]);
+        __m512d ymm3 = _mm512_set_pd(dat[j + 7].dat[1], dat[j + 6].dat[1], dat[j + 5].dat[1], dat[j + 4].dat[1],
+                                     dat[j + 3].dat[1], dat[j + 2].dat[1], dat[j + 1].dat[1], dat[j].dat[1]);
+
+        __m512d ymm4 = _mm512_sub_pd(ymm2, _mm512_mul_pd(ymm1, priReal));
+        __m512d ymm5 = _mm512_sub_pd(ymm3, _mm512_mul_pd(ymm1, priImag));
+
+        ymm4 = _mm512_add_pd(_mm512_mul_pd(ymm4, ymm4), _mm512_mul_pd(ymm5, ymm5));
+        ymm4 = _mm512_mul_pd(ymm4, _mm512_loadu_pd(sigRcp + j));
+
+        _mm512_storeu_pd(result + j, _mm512_add_pd(_mm512_loadu_pd(result + j), ymm4));
+    }
+#endif
+#else
+#ifdef ENABLE_SIMD_256
+#ifdef SINGLE_PRECISION
+    __m256 priReal = _mm256_set1_ps(pri.dat[0]);
+    __m256 priImag = _mm256_set1_ps(pri.dat[1]);
+
+    for (; j <= (n - 8); j += 8)
+    {
+        __m256 ymm1 = _mm256_loadu_ps(ctf + j);
+        __m256 ymm2 = _mm256_set_ps(dat[j + 7].dat[0], dat[j + 6].dat[0], dat[j + 5].dat[0], dat[j + 4].dat[0],
+                                    dat[j + 3].dat[0], dat[j + 2].dat[0], dat[j + 1].dat[0], dat[j].dat[0]);
+        __m256 ymm3 = _mm256_set_ps(dat[j + 7].dat[1], dat[j + 6].dat[1], dat[j + 5].dat[1], dat[j + 4].dat[1],
+                                    dat[j + 3].dat[1], dat[j + 2].dat[1], dat[j + 1].dat[1], dat[j].dat[1]);
+
+        __m256 ymm4 = _mm256_sub_ps(ymm2, _mm256_mul_ps(ymm1, priReal));
+        __m256 ymm5 = _mm256_sub_ps(ymm3, _mm256_mul_ps(ymm1, priImag));
+
+        ymm4 = _mm256_add_ps(_mm256_mul_ps(ymm4, ymm4), _mm256_mul_ps(ymm5, ymm5));
+        ymm4 = _mm256_mul_ps(ymm4, _mm256_loadu_ps(sigRcp + j));
+
+        _mm256_storeu_ps(result + j, _mm256_add_ps(_mm256_loadu_ps(result + j), ymm4));
+    }
+#else
+    __m256d priReal = _mm256_set1_pd(pri.dat[0]);
+    __m256d priImag = _mm256_set1_pd(pri.dat[1]);
+
+    for (; j <= (n - 4); j += 4)
+    {
+        __m256d ymm1 = _mm256_loadu_pd(ctf + j);
+        __m256d ymm2 = _mm256_set_pd(dat[j + 3].dat[0], dat[j + 2].dat[0], dat[j + 1].dat[0], dat[j].dat[0]);
+        __m256d ymm3 = _mm256_set_pd(dat[j + 3].dat[1], dat[j + 2].dat[1], dat[j + 1].dat[1], dat[j].dat[1]);
+
+        __m256d ymm4 = _mm256_sub_pd(ymm2, _mm256_mul_pd(ymm1, priReal));
+        __m256d ymm5 = _mm256_sub_pd(ymm3, _mm256_mul_pd(ymm1, priImag));
+
+        ymm4 = _mm256_add_pd(_mm256_mul_pd(ymm4, ymm4), _mm256_mul_pd(ymm5, ymm5));
+        ymm4 = _mm256_mul_pd(ymm4, _mm256_loadu_pd(sigRcp + j));
+
+        _mm256_storeu_pd(result + j, _mm256_add_pd(_mm256_loadu_pd(result + j), ymm4));
+    }
+#endif
+#endif
+#endif
+
+    // process remaining images of this block
+
+    for (; j < n; j++)
+    {
+        RFLOAT tmpReal = dat[j].dat[0] - ctf[j] * pri.dat[0];
+        RFLOAT tmpImag = dat[j].dat[1] - ctf[j] * pri.dat[1];
+
+        result[j] += (tmpReal * tmpReal + tmpImag * tmpImag) * sigRcp[j];
+    }
+}
+
+/**
+ *  blocked scan of a block of n images against nT translations of one
+ *  rotation, dat is pixel-major with leading dimension ld, tra stores nT
+ *  translations of m pixels each, result is nT x n
+ *
+ *  Each pixel row of the block is loaded once and reused by all the
+ *  translations while the nT x n accumulators stay in L1, instead of
+ *  streaming the whole stack of images once per translation.
+ *
+ *  ctf and sigRcp are pixel-major with leading dimension ldCTF and ldSig.
+ *  If ctfIdx (sigIdx) is not NULL, ctf (sigRcp) holds one column per distinct
+ *  CTF (group) and ctfIdx (sigIdx) gives the column of each image of the
+ *  block, n should not exceed GLOBAL_SCAN_BLOCK_IMG.
+ */
+void logDataVSPrior_m_n_t_huabin(RFLOAT* result, const Complex* dat, const Complex* priRot, const Complex* tra, const RFLOAT* ctf, const int* ctfIdx, const int ldCTF, const RFLOAT* sigRcp, const int* sigIdx, const int ldSig, const int n, const int ld, const int m, const int nT)
+{
+    RFLOAT ctfBlock[GLOBAL_SCAN_BLOCK_IMG];
+    RFLOAT sigRcpBlock[GLOBAL_SCAN_BLOCK_IMG];
+
+    for (int i = 0; i < m; i++)
+    {
+        size_t idx = (size_t)i * ld;
+
+        const RFLOAT* ctfRow = ctf + (size_t)i * ldCTF;
+        const RFLOAT* sigRcpRow = sigRcp + (size_t)i * ldSig;
+
+        // gather the CTF and sigma of this pixel once for all the translations
+
+        if (ctfIdx != NULL)
+        {
+            for (int j = 0; j < n; j++)
+                ctfBlock[j] = ctfRow[ctfIdx[j]];
+
+            ctfRow = ctfBlock;
+        }
+
+        if (sigIdx != NULL)
+        {
+            for (int j = 0; j < n; j++)
+                sigRcpBlock[j] = sigRcpRow[sigIdx[j]];
+
+            sigRcpRow = sigRcpBlock;
+        }
+
+        for (int t = 0; t < nT; t++)
+        {
+            logDataVSPrior_row_huabin(result + (size_t)t * n,
+                                      dat + idx,
+                                      tra[(size_t)t * m + i] * priRot[i],
+                                      ctfRow,
+                                      sigRcpRow,
+                                      n);
+        }
+    }
+}
+
+#endif
+
 RFLOAT logDataVSPrior(const Image& dat,
                       const Image& pri,
                       const Image& ctf,
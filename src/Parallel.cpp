@@ -10,6 +10,12 @@
 
 #include <exception>
 
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
 Parallel::Parallel() {}
 
 Parallel::~Parallel() {}
@@ -247,6 +253,412 @@ void MPI_Ssend_Large(const void* buf,
     }
 }
 
+#ifdef PARALLEL_NODE_AWARE
+
+/**
+ * the node topology of a communicator, cached as an attribute of it
+ */
+struct NodeTopo
+{
+    MPI_Comm node;
+
+    MPI_Comm leader;
+
+    int nodeRank;
+
+    int nodeSize;
+
+    /**
+     * whether every node holds only one process of the communicator
+     */
+    bool flat;
+
+    /**
+     * the rank in the leader communicator of the leader of the node of each process
+     */
+    std::vector<int> leaderOf;
+
+    /**
+     * shared memory of the node, a slot per process and two result chunks
+     */
+    MPI_Win win;
+
+    char* base;
+
+    /**
+     * shared memory of the node held by its first process, for data which
+     * processes share instead of keeping a copy each
+     */
+    MPI_Win segWin;
+
+    char* segBase;
+
+    size_t segSize;
+};
+
+static int nodeTopoKey = MPI_KEYVAL_INVALID;
+
+static int nodeFinalizeKey = MPI_KEYVAL_INVALID;
+
+/**
+ * the communicators holding a node topology
+ */
+static std::vector<MPI_Comm> nodeTopoComm;
+
+static int nodeTopoDelete(MPI_Comm comm,
+                          int keyval,
+                          void* attr,
+                          void* extra)
+{
+    NodeTopo* topo = static_cast<NodeTopo*>(attr);
+
+    for (size_t i = 0; i < nodeTopoComm.size(); i++)
+        if (nodeTopoComm[i] == comm)
+        {
+            nodeTopoComm.erase(nodeTopoComm.begin() + i);
+
+            break;
+        }
+
+    if (topo->win != MPI_WIN_NULL)
+    {
+        MPI_Win_unlock_all(topo->win);
+        MPI_Win_free(&topo->win);
+    }
+
+    if (topo->segWin != MPI_WIN_NULL)
+    {
+        MPI_Win_unlock_all(topo->segWin);
+        MPI_Win_free(&topo->segWin);
+    }
+
+    if (topo->leader != MPI_COMM_NULL) MPI_Comm_free(&topo->leader);
+
+    MPI_Comm_free(&topo->node);
+
+    delete topo;
+
+    return MPI_SUCCESS;
+}
+
+/**
+ * attributes of MPI_COMM_SELF are deleted first in MPI_Finalize, while MPI is
+ * still functional, windows and communicators of node topologies are freed
+ * there, as freeing them along with MPI_COMM_WORLD fails
+ */
+static int nodeFinalize(MPI_Comm comm,
+                        int keyval,
+                        void* attr,
+                        void* extra)
+{
+    while (!nodeTopoComm.empty())
+        MPI_Comm_delete_attr(nodeTopoComm.back(), nodeTopoKey);
+
+    return MPI_SUCCESS;
+}
+
+static NodeTopo* nodeTopo(MPI_Comm comm)
+{
+    if (nodeTopoKey == MPI_KEYVAL_INVALID)
+    {
+        MPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN,
+                               nodeTopoDelete,
+                               &nodeTopoKey,
+                               NULL);
+
+        MPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN,
+                               nodeFinalize,
+                               &nodeFinalizeKey,
+                               NULL);
+
+        MPI_Comm_set_attr(MPI_COMM_SELF, nodeFinalizeKey, NULL);
+    }
+
+    NodeTopo* topo;
+    int flag;
+
+    MPI_Comm_get_attr(comm, nodeTopoKey, &topo, &flag);
+
+    if (flag) return topo;
+
+    topo = new NodeTopo;
+
+    int rank, size;
+
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &topo->node);
+
+    MPI_Comm_rank(topo->node, &topo->nodeRank);
+    MPI_Comm_size(topo->node, &topo->nodeSize);
+
+    MPI_Comm_split(comm,
+                   (topo->nodeRank == 0) ? 0 : MPI_UNDEFINED,
+                   rank,
+                   &topo->leader);
+
+    int leaderRank = -1;
+
+    if (topo->leader != MPI_COMM_NULL) MPI_Comm_rank(topo->leader, &leaderRank);
+
+    MPI_Bcast(&leaderRank, 1, MPI_INT, 0, topo->node);
+
+    topo->leaderOf.resize(size);
+
+    MPI_Allgather(&leaderRank, 1, MPI_INT, &topo->leaderOf[0], 1, MPI_INT, comm);
+
+    int maxNodeSize;
+
+    MPI_Allreduce(&topo->nodeSize, &maxNodeSize, 1, MPI_INT, MPI_MAX, comm);
+
+    topo->flat = (maxNodeSize == 1);
+
+    topo->win = MPI_WIN_NULL;
+    topo->base = NULL;
+
+    topo->segWin = MPI_WIN_NULL;
+    topo->segBase = NULL;
+    topo->segSize = 0;
+
+    MPI_Comm_set_attr(comm, nodeTopoKey, topo);
+
+    nodeTopoComm.push_back(comm);
+
+    return topo;
+}
+
+/**
+ * allocate the shared memory of the node on first use, the first process of
+ * the node holds the whole window, thus slots are contiguous
+ */
+static char* nodeWindow(NodeTopo* topo)
+{
+    if (topo->win != MPI_WIN_NULL) return topo->base;
+
+    MPI_Aint size = (topo->nodeRank == 0)
+                  ? (MPI_Aint)(topo->nodeSize + 2) * MPI_NODE_CHUNK
+                  : 0;
+
+    char* ptr;
+
+    MPI_Win_allocate_shared(size, 1, MPI_INFO_NULL, topo->node, &ptr, &topo->win);
+
+    int dispUnit;
+
+    MPI_Win_shared_query(topo->win, 0, &size, &dispUnit, &topo->base);
+
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, topo->win);
+
+    return topo->base;
+}
+
+/**
+ * make writes to the shared memory by each process of the node visible to all
+ */
+static inline void nodeSync(NodeTopo* topo)
+{
+    MPI_Win_sync(topo->win);
+    MPI_Barrier(topo->node);
+    MPI_Win_sync(topo->win);
+}
+
+template <typename T>
+static void nodeSum(T* dst,
+                    const char* base,
+                    const int nodeSize,
+                    const size_t begin,
+                    const size_t end)
+{
+    const T* src = reinterpret_cast<const T*>(base);
+
+    size_t stride = MPI_NODE_CHUNK / sizeof(T);
+
+    for (size_t i = begin; i < end; i++)
+        dst[i] = src[i];
+
+    for (int r = 1; r < nodeSize; r++)
+        for (size_t i = begin; i < end; i++)
+            dst[i] += src[r * stride + i];
+}
+
+void MPI_Comm_Split_Node(MPI_Comm comm,
+                         MPI_Comm* node,
+                         MPI_Comm* leader)
+{
+    NodeTopo* topo = nodeTopo(comm);
+
+    *node = topo->node;
+    *leader = topo->leader;
+}
+
+char* MPI_Alloc_Shared_Node(MPI_Comm comm,
+                            size_t size)
+{
+    NodeTopo* topo = nodeTopo(comm);
+
+    if ((topo->segWin != MPI_WIN_NULL) && (topo->segSize >= size))
+        return topo->segBase;
+
+    if (topo->segWin != MPI_WIN_NULL)
+    {
+        MPI_Win_unlock_all(topo->segWin);
+        MPI_Win_free(&topo->segWin);
+    }
+
+    MPI_Aint segSize = (topo->nodeRank == 0) ? (MPI_Aint)size : 0;
+
+    char* ptr;
+
+    MPI_Win_allocate_shared(segSize, 1, MPI_INFO_NULL, topo->node, &ptr, &topo->segWin);
+
+    int dispUnit;
+
+    MPI_Win_shared_query(topo->segWin, 0, &segSize, &dispUnit, &topo->segBase);
+
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, topo->segWin);
+
+    topo->segSize = size;
+
+    return topo->segBase;
+}
+
+void MPI_Sync_Shared_Node(MPI_Comm comm)
+{
+    NodeTopo* topo = nodeTopo(comm);
+
+    if (topo->segWin != MPI_WIN_NULL)
+        MPI_Win_sync(topo->segWin);
+
+    MPI_Barrier(topo->node);
+
+    if (topo->segWin != MPI_WIN_NULL)
+        MPI_Win_sync(topo->segWin);
+}
+
+static void MPI_Bcast_Node(char* buf,
+                           size_t size,
+                           int root,
+                           MPI_Comm comm,
+                           NodeTopo* topo)
+{
+    char* base = nodeWindow(topo);
+
+    char* result[2] = {base + (size_t)topo->nodeSize * MPI_NODE_CHUNK,
+                       base + (size_t)(topo->nodeSize + 1) * MPI_NODE_CHUNK};
+
+    int rank;
+
+    MPI_Comm_rank(comm, &rank);
+
+    int rootLeader = topo->leaderOf[root];
+
+    bool rootNode = (topo->leaderOf[rank] == rootLeader);
+
+    size_t nChunk = (size + MPI_NODE_CHUNK - 1) / MPI_NODE_CHUNK;
+
+    MPI_Request req[2] = {MPI_REQUEST_NULL, MPI_REQUEST_NULL};
+
+    // the broadcast of a chunk among leaders overlaps the copying out of the previous one
+
+    for (size_t c = 0; c <= nChunk; c++)
+    {
+        if (c < nChunk)
+        {
+            size_t n = GSL_MIN(size - c * MPI_NODE_CHUNK, MPI_NODE_CHUNK);
+
+            // the result chunk is free once the chunk two steps before is copied out
+
+            nodeSync(topo);
+
+            if (rootNode)
+            {
+                if (rank == root)
+                    memcpy(result[c % 2], buf + c * MPI_NODE_CHUNK, n);
+
+                nodeSync(topo);
+            }
+
+            if (topo->leader != MPI_COMM_NULL)
+                MPI_Ibcast(result[c % 2], n, MPI_BYTE, rootLeader, topo->leader, &req[c % 2]);
+        }
+
+        if (c > 0)
+        {
+            size_t n = GSL_MIN(size - (c - 1) * MPI_NODE_CHUNK, MPI_NODE_CHUNK);
+
+            if (topo->leader != MPI_COMM_NULL)
+                MPI_Wait(&req[(c - 1) % 2], MPI_STATUS_IGNORE);
+
+            nodeSync(topo);
+
+            if (rank != root)
+                memcpy(buf + (c - 1) * MPI_NODE_CHUNK, result[(c - 1) % 2], n);
+        }
+    }
+}
+
+template <typename T>
+static void MPI_Allreduce_Node(T* buf,
+                               size_t count,
+                               MPI_Datatype datatype,
+                               NodeTopo* topo)
+{
+    char* base = nodeWindow(topo);
+
+    T* slot = reinterpret_cast<T*>(base + (size_t)topo->nodeRank * MPI_NODE_CHUNK);
+
+    T* result[2] = {reinterpret_cast<T*>(base + (size_t)topo->nodeSize * MPI_NODE_CHUNK),
+                    reinterpret_cast<T*>(base + (size_t)(topo->nodeSize + 1) * MPI_NODE_CHUNK)};
+
+    size_t chunk = MPI_NODE_CHUNK / sizeof(T);
+
+    size_t nChunk = (count + chunk - 1) / chunk;
+
+    MPI_Request req[2] = {MPI_REQUEST_NULL, MPI_REQUEST_NULL};
+
+    // the all reducing of a chunk among leaders overlaps the reducing of the next one within node
+
+    for (size_t c = 0; c <= nChunk; c++)
+    {
+        if (c < nChunk)
+        {
+            size_t n = GSL_MIN(count - c * chunk, chunk);
+
+            memcpy(slot, buf + c * chunk, n * sizeof(T));
+
+            nodeSync(topo);
+
+            // each process sums its segment of the chunk over all processes of the node
+
+            nodeSum(result[c % 2],
+                    base,
+                    topo->nodeSize,
+                    n * topo->nodeRank / topo->nodeSize,
+                    n * (topo->nodeRank + 1) / topo->nodeSize);
+
+            nodeSync(topo);
+
+            if (topo->leader != MPI_COMM_NULL)
+                MPI_Iallreduce(MPI_IN_PLACE, result[c % 2], n, datatype, MPI_SUM, topo->leader, &req[c % 2]);
+        }
+
+        if (c > 0)
+        {
+            size_t n = GSL_MIN(count - (c - 1) * chunk, chunk);
+
+            if (topo->leader != MPI_COMM_NULL)
+                MPI_Wait(&req[(c - 1) % 2], MPI_STATUS_IGNORE);
+
+            nodeSync(topo);
+
+            memcpy(buf + (c - 1) * chunk, result[(c - 1) % 2], n * sizeof(T));
+        }
+    }
+}
+
+#endif
+
 void MPI_Bcast_Large(void* buf,
                      size_t count,
                      MPI_Datatype datatype,
@@ -256,6 +668,22 @@ void MPI_Bcast_Large(void* buf,
     int dataTypeSize;
     MPI_Type_size(datatype, &dataTypeSize);
 
+#ifdef PARALLEL_NODE_AWARE
+
+    NodeTopo* topo = nodeTopo(comm);
+
+    MPI_Aint lb, extent;
+    MPI_Type_get_extent(datatype, &lb, &extent);
+
+    if ((!topo->flat) && (lb == 0) && (extent == dataTypeSize))
+    {
+        MPI_Bcast_Node(static_cast<char*>(buf), count * dataTypeSize, root, comm, topo);
+
+        return;
+    }
+
+#endif
+
     int nBlock = (count - 1) / (MPI_MAX_BUF / dataTypeSize) + 1;
 
 #ifdef VERBOSE_LEVEL_2
@@ -305,6 +733,31 @@ void MPI_Allreduce_Large(void* buf,
     int dataTypeSize;
     MPI_Type_size(datatype, &dataTypeSize);
 
+#ifdef PARALLEL_NODE_AWARE
+
+    NodeTopo* topo = nodeTopo(comm);
+
+    if ((!topo->flat) && (op == MPI_SUM))
+    {
+        // complex types are summed as pairs of real numbers
+
+        if ((datatype == MPI_FLOAT) || (datatype == MPI_COMPLEX) || (datatype == MPI_C_FLOAT_COMPLEX))
+        {
+            MPI_Allreduce_Node(static_cast<float*>(buf), count * dataTypeSize / sizeof(float), MPI_FLOAT, topo);
+
+            return;
+        }
+
+        if ((datatype == MPI_DOUBLE) || (datatype == MPI_DOUBLE_COMPLEX) || (datatype == MPI_C_DOUBLE_COMPLEX))
+        {
+            MPI_Allreduce_Node(static_cast<double*>(buf), count * dataTypeSize / sizeof(double), MPI_DOUBLE, topo);
+
+            return;
+        }
+    }
+
+#endif
+
     int nBlock = (count - 1) / (MPI_MAX_BUF / dataTypeSize) + 1;
 
 #ifdef VERBOSE_LEVEL_2
@@ -345,3 +798,56 @@ void MPI_Allreduce_Large(void* buf,
         ptr += MPI_MAX_BUF;
     }
 }
+
+void MPI_Write_Ordered_Large(const char* filename,
+                             const void* buf,
+                             size_t size,
+                             MPI_Comm comm)
+{
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+
+    unsigned long long local = size;
+    unsigned long long offset = 0;
+    unsigned long long total = 0;
+
+    MPI_Exscan(&local, &offset, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, comm);
+
+    if (rank == 0) offset = 0;
+
+    MPI_Allreduce(&local, &total, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, comm);
+
+    if (rank == 0)
+    {
+        int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+        if (fd == -1) REPORT_ERROR("FAIL TO CREATE FILE");
+
+        if (ftruncate(fd, total) == -1) REPORT_ERROR("FAIL TO ALLOCATE FILE");
+
+        close(fd);
+    }
+
+    MPI_Barrier(comm);
+
+    int fd = open(filename, O_WRONLY);
+
+    if (fd == -1) REPORT_ERROR("FAIL TO OPEN FILE");
+
+    const char* ptr = static_cast<const char*>(buf);
+
+    while (size > 0)
+    {
+        ssize_t n = pwrite(fd, ptr, size, offset);
+
+        if (n <= 0) REPORT_ERROR("FAIL TO WRITE FILE");
+
+        ptr += n;
+        size -= n;
+        offset += n;
+    }
+
+    close(fd);
+
+    MPI_Barrier(comm);
+}
@@ -553,6 +553,94 @@ void Particle::load(const int nR,
     _score = score;
 }
 
+void Particle::saveCheckpoint(Checkpoint& cp) const
+{
+    cp.put(_mode);
+    cp.put(_nC);
+    cp.put(_nR);
+    cp.put(_nT);
+    cp.put(_nD);
+    cp.put(_transS);
+    cp.put(_transQ);
+    cp.put(_peakFactorC);
+    cp.put(_peakFactorR);
+    cp.put(_peakFactorT);
+    cp.put(_peakFactorD);
+    cp.put(_k1);
+    cp.put(_k2);
+    cp.put(_k3);
+    cp.put(_s0);
+    cp.put(_s1);
+    cp.put(_rho);
+    cp.put(_s);
+    cp.put(_score);
+    cp.put(_topCPrev);
+    cp.put(_topC);
+    cp.put(_topDPrev);
+    cp.put(_topD);
+
+    cp.putMatrix(_c);
+    cp.putMatrix(_r);
+    cp.putMatrix(_t);
+    cp.putMatrix(_d);
+    cp.putMatrix(_wC);
+    cp.putMatrix(_wR);
+    cp.putMatrix(_wT);
+    cp.putMatrix(_wD);
+    cp.putMatrix(_uC);
+    cp.putMatrix(_uR);
+    cp.putMatrix(_uT);
+    cp.putMatrix(_uD);
+    cp.putMatrix(_topRPrev);
+    cp.putMatrix(_topR);
+    cp.putMatrix(_topTPrev);
+    cp.putMatrix(_topT);
+}
+
+void Particle::loadCheckpoint(Checkpoint& cp)
+{
+    cp.get(_mode);
+    cp.get(_nC);
+    cp.get(_nR);
+    cp.get(_nT);
+    cp.get(_nD);
+    cp.get(_transS);
+    cp.get(_transQ);
+    cp.get(_peakFactorC);
+    cp.get(_peakFactorR);
+    cp.get(_peakFactorT);
+    cp.get(_peakFactorD);
+    cp.get(_k1);
+    cp.get(_k2);
+    cp.get(_k3);
+    cp.get(_s0);
+    cp.get(_s1);
+    cp.get(_rho);
+    cp.get(_s);
+    cp.get(_score);
+    cp.get(_topCPrev);
+    cp.get(_topC);
+    cp.get(_topDPrev);
+    cp.get(_topD);
+
+    cp.getMatrix(_c);
+    cp.getMatrix(_r);
+    cp.getMatrix(_t);
+    cp.getMatrix(_d);
+    cp.getMatrix(_wC);
+    cp.getMatrix(_wR);
+    cp.getMatrix(_wT);
+    cp.getMatrix(_wD);
+    cp.getMatrix(_uC);
+    cp.getMatrix(_uR);
+    cp.getMatrix(_uT);
+    cp.getMatrix(_uD);
+    cp.getMatrix(_topRPrev);
+    cp.getMatrix(_topR);
+    cp.getMatrix(_topTPrev);
+    cp.getMatrix(_topT);
+}
+
 void Particle::vari(double& k1,
                     double& k2,
                     double& k3,
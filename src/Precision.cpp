@@ -589,6 +589,24 @@ TSFFTW_PLAN TSFFTW_plan_dft_c2r_3d(int n0, int n1, int n2, TSFFTW_COMPLEX *in, R
 #endif
 }
 
+TSFFTW_PLAN TSFFTW_plan_many_dft_r2c(int rank, const int *n, int howmany, RFLOAT *in, int idist, TSFFTW_COMPLEX *out, int odist, unsigned flags)
+{
+#ifdef SINGLE_PRECISION
+	return fftwf_plan_many_dft_r2c(rank, n, howmany, in, NULL, 1, idist, out, NULL, 1, odist, flags);
+#else
+	return fftw_plan_many_dft_r2c(rank, n, howmany, in, NULL, 1, idist, out, NULL, 1, odist, flags);
+#endif
+}
+
+TSFFTW_PLAN TSFFTW_plan_many_dft_c2r(int rank, const int *n, int howmany, TSFFTW_COMPLEX *in, int idist, RFLOAT *out, int odist, unsigned flags)
+{
+#ifdef SINGLE_PRECISION
+	return fftwf_plan_many_dft_c2r(rank, n, howmany, in, NULL, 1, idist, out, NULL, 1, odist, flags);
+#else
+	return fftw_plan_many_dft_c2r(rank, n, howmany, in, NULL, 1, idist, out, NULL, 1, odist, flags);
+#endif
+}
+
 void TSFFTW_plan_with_nthreads(int nthreads)
 {
 #ifdef SINGLE_PRECISION
@@ -606,3 +624,30 @@ void TSFFTW_set_timelimit(RFLOAT seconds)
 	fftw_set_timelimit(seconds);
 #endif
 }
+
+int TSFFTW_alignment_of(RFLOAT *p)
+{
+#ifdef SINGLE_PRECISION
+	return fftwf_alignment_of(p);
+#else
+	return fftw_alignment_of(p);
+#endif
+}
+
+int TSFFTW_import_wisdom_from_filename(const char *filename)
+{
+#ifdef SINGLE_PRECISION
+	return fftwf_import_wisdom_from_filename(filename);
+#else
+	return fftw_import_wisdom_from_filename(filename);
+#endif
+}
+
+int TSFFTW_export_wisdom_to_filename(const char *filename)
+{
+#ifdef SINGLE_PRECISION
+	return fftwf_export_wisdom_to_filename(filename);
+#else
+	return fftw_export_wisdom_to_filename(filename);
+#endif
+}
@@ -0,0 +1,443 @@
+/*******************************************************************************
+ * Author: Mingxu Hu
+ * Dependency:
+ * Test:
+ * Execution:
+ * Description:
+ *
+ * Manual:
+ * ****************************************************************************/
+
+#include "Profiler.h"
+#include "Parallel.h"
+#include "omp_compat.h"
+
+#include <map>
+#include <deque>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+
+struct ProfilerNode
+{
+    /**
+     * the name of the scope, NULL for a node standing for a scope of the main
+     * thread, under which scopes of a worker thread are hung
+     */
+    const char* name;
+
+    std::string path;
+
+    std::vector<int> children;
+
+    double time;
+
+    long count;
+};
+
+struct ProfilerEvent
+{
+    int node;
+
+    double start;
+
+    double end;
+};
+
+struct ProfilerThread
+{
+    int id;
+
+    /**
+     * nodes are never moved, thus the path of a node of the main thread can be
+     * read by worker threads while the main thread appends nodes
+     */
+    std::deque<ProfilerNode> nodes;
+
+    std::vector<int> roots;
+
+    std::vector<int> stack;
+
+    std::vector<ProfilerEvent> events;
+
+    long nDropped;
+};
+
+bool Profiler::_enabled = false;
+
+bool Profiler::_trace = false;
+
+double Profiler::_origin = 0;
+
+static std::vector<ProfilerThread*> profilerThreads;
+
+/**
+ * the path of the innermost scope of the main thread opened out of parallel
+ * regions, NULL if none is open
+ */
+static std::atomic<const std::string*> profilerMainPath(NULL);
+
+static thread_local ProfilerThread* profilerSelf = NULL;
+
+static ProfilerThread* profilerThread()
+{
+    if (profilerSelf == NULL)
+    {
+        profilerSelf = new ProfilerThread();
+
+        profilerSelf->nDropped = 0;
+
+        #pragma omp critical (Profiler)
+        {
+            profilerSelf->id = profilerThreads.size();
+
+            profilerThreads.push_back(profilerSelf);
+        }
+    }
+
+    return profilerSelf;
+}
+
+static bool profilerInParallel()
+{
+#ifdef _OPENMP
+    return omp_in_parallel();
+#else
+    return false;
+#endif
+}
+
+static int profilerChild(ProfilerThread* t,
+                         const int parent,
+                         const char* name,
+                         const std::string& path)
+{
+    std::vector<int>& children = (parent == -1) ? t->roots : t->nodes[parent].children;
+
+    for (size_t i = 0; i < children.size(); i++)
+    {
+        const ProfilerNode& node = t->nodes[children[i]];
+
+        if ((name == NULL) ? (node.name == NULL) && (node.path == path)
+                           : (node.name != NULL) && (strcmp(node.name, name) == 0))
+            return children[i];
+    }
+
+    ProfilerNode node;
+
+    node.name = name;
+    node.time = 0;
+    node.count = 0;
+
+    if (name == NULL)
+        node.path = path;
+    else if (parent == -1)
+        node.path = name;
+    else
+        node.path = t->nodes[parent].path + "/" + name;
+
+    t->nodes.push_back(node);
+
+    children.push_back(t->nodes.size() - 1);
+
+    return children.back();
+}
+
+void Profiler::enable(const bool trace,
+                      MPI_Comm comm)
+{
+    // the thread enabling the profiler is the main thread
+
+    profilerThread();
+
+    MPI_Barrier(comm);
+
+    _trace = trace;
+    _origin = time();
+
+    _enabled = true;
+}
+
+int Profiler::enter(const char* name)
+{
+    ProfilerThread* t = profilerThread();
+
+    int parent = -1;
+
+    if (!t->stack.empty())
+        parent = t->stack.back();
+    else if (t->id != 0)
+    {
+        const std::string* path = profilerMainPath.load();
+
+        if (path != NULL) parent = profilerChild(t, -1, NULL, *path);
+    }
+
+    int node = profilerChild(t, parent, name, std::string());
+
+    t->stack.push_back(node);
+
+    if ((t->id == 0) && !profilerInParallel())
+        profilerMainPath.store(&t->nodes[node].path);
+
+    return node;
+}
+
+void Profiler::leave(const int node,
+                     const double start)
+{
+    double end = time();
+
+    ProfilerThread* t = profilerSelf;
+
+    t->nodes[node].time += end - start;
+    t->nodes[node].count += 1;
+
+    t->stack.pop_back();
+
+    if ((t->id == 0) && !profilerInParallel())
+        profilerMainPath.store(t->stack.empty() ? NULL : &t->nodes[t->stack.back()].path);
+
+    if (_trace)
+    {
+        if (t->events.size() < PROFILER_MAX_TRACE_EVENTS)
+        {
+            ProfilerEvent event;
+
+            event.node = node;
+            event.start = start;
+            event.end = end;
+
+            t->events.push_back(event);
+        }
+        else
+            t->nDropped += 1;
+    }
+}
+
+void Profiler::report(const int iter,
+                      const char* prefix,
+                      MPI_Comm comm)
+{
+    if (!_enabled) return;
+
+    int rank, size;
+
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    char line[FILE_NAME_LENGTH * 2];
+
+    std::string text;
+
+    // the time and count of each path summed over threads of this process
+
+    std::map<std::string, std::pair<double, long> > sum;
+
+    long nDropped = 0;
+
+    for (size_t i = 0; i < profilerThreads.size(); i++)
+    {
+        ProfilerThread* t = profilerThreads[i];
+
+        for (size_t j = 0; j < t->nodes.size(); j++)
+        {
+            ProfilerNode& node = t->nodes[j];
+
+            if (node.count == 0) continue;
+
+            snprintf(line,
+                     sizeof(line),
+                     "RANK %6d THREAD %3d %12.6f %10ld %s\n",
+                     rank,
+                     t->id,
+                     node.time,
+                     node.count,
+                     node.path.c_str());
+
+            text += line;
+
+            sum[node.path].first += node.time;
+            sum[node.path].second += node.count;
+        }
+
+        nDropped += t->nDropped;
+    }
+
+    char filename[FILE_NAME_LENGTH];
+
+    sprintf(filename, "%sProfile_Round_%03d.txt", prefix, iter);
+
+    MPI_Write_Ordered_Large(filename, text.data(), text.size(), comm);
+
+    if (_trace)
+    {
+        text.clear();
+
+        if (rank == 0) text += "[";
+
+        snprintf(line,
+                 sizeof(line),
+                 "%s\n{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": %d, \"args\": {\"name\": \"Rank %d\"}}",
+                 (rank == 0) ? "" : ",",
+                 rank,
+                 rank);
+
+        text += line;
+
+        for (size_t i = 0; i < profilerThreads.size(); i++)
+        {
+            ProfilerThread* t = profilerThreads[i];
+
+            for (size_t j = 0; j < t->events.size(); j++)
+            {
+                const ProfilerEvent& event = t->events[j];
+
+                snprintf(line,
+                         sizeof(line),
+                         ",\n{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", \"pid\": %d, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}",
+                         t->nodes[event.node].name,
+                         t->nodes[event.node].path.c_str(),
+                         rank,
+                         t->id,
+                         (event.start - _origin) * 1e6,
+                         (event.end - event.start) * 1e6);
+
+                text += line;
+            }
+        }
+
+        if (rank == size - 1) text += "\n]\n";
+
+        sprintf(filename, "%sTrace_Round_%03d.json", prefix, iter);
+
+        MPI_Write_Ordered_Large(filename, text.data(), text.size(), comm);
+    }
+
+    // gather the sums of all processes to the first one
+
+    text.clear();
+
+    for (std::map<std::string, std::pair<double, long> >::const_iterator it = sum.begin();
+         it != sum.end();
+         ++it)
+    {
+        snprintf(line, sizeof(line), "%.9e %ld %s\n", it->second.first, it->second.second, it->first.c_str());
+
+        text += line;
+    }
+
+    int len = text.size();
+
+    std::vector<int> lens(size), displs(size, 0);
+
+    MPI_Gather(&len, 1, MPI_INT, &lens[0], 1, MPI_INT, 0, comm);
+
+    for (int i = 1; i < size; i++)
+        displs[i] = displs[i - 1] + lens[i - 1];
+
+    std::vector<char> all((rank == 0) ? displs[size - 1] + lens[size - 1] + 1 : 1, '\0');
+
+    MPI_Gatherv(text.data(), len, MPI_CHAR, &all[0], &lens[0], &displs[0], MPI_CHAR, 0, comm);
+
+    MPI_Allreduce(MPI_IN_PLACE, &nDropped, 1, MPI_LONG, MPI_SUM, comm);
+
+    if (rank == 0)
+    {
+        struct Stat
+        {
+            double min, max, sum;
+
+            int minRank, maxRank, n;
+
+            long count;
+        };
+
+        std::map<std::string, Stat> stat;
+
+        for (int i = 0; i < size; i++)
+        {
+            const char* p = &all[displs[i]];
+            const char* end = p + lens[i];
+
+            while (p < end)
+            {
+                double time;
+                long count;
+                int n;
+
+                sscanf(p, "%lf %ld %n", &time, &count, &n);
+
+                const char* eol = strchr(p + n, '\n');
+
+                std::string path(p + n, eol);
+
+                std::map<std::string, Stat>::iterator it = stat.find(path);
+
+                if (it == stat.end())
+                {
+                    Stat s = {time, time, 0, i, i, 0, 0};
+
+                    it = stat.insert(std::make_pair(path, s)).first;
+                }
+
+                Stat& s = it->second;
+
+                if (time < s.min) { s.min = time; s.minRank = i; }
+                if (time > s.max) { s.max = time; s.maxRank = i; }
+
+                s.sum += time;
+                s.n += 1;
+                s.count += count;
+
+                p = eol + 1;
+            }
+        }
+
+        CLOG(INFO, "LOGGER_PROF") << "Round " << iter
+                                  << ": Seconds of Scopes Summed over Threads, as Mean, Min (Rank) and Max (Rank) among Processes, Processes, Calls";
+
+        for (std::map<std::string, Stat>::const_iterator it = stat.begin();
+             it != stat.end();
+             ++it)
+        {
+            const Stat& s = it->second;
+
+            snprintf(line,
+                     sizeof(line),
+                     "%12.6f %12.6f (%d) %12.6f (%d) %6d %10ld %s",
+                     s.sum / s.n,
+                     s.min,
+                     s.minRank,
+                     s.max,
+                     s.maxRank,
+                     s.n,
+                     s.count,
+                     it->first.c_str());
+
+            CLOG(INFO, "LOGGER_PROF") << line;
+        }
+
+        if (nDropped > 0)
+            CLOG(WARNING, "LOGGER_PROF") << nDropped
+                                         << " Scopes Exceeding "
+                                         << PROFILER_MAX_TRACE_EVENTS
+                                         << " Events per Thread are Left out of Trace";
+    }
+
+    for (size_t i = 0; i < profilerThreads.size(); i++)
+    {
+        ProfilerThread* t = profilerThreads[i];
+
+        for (size_t j = 0; j < t->nodes.size(); j++)
+        {
+            t->nodes[j].time = 0;
+            t->nodes[j].count = 0;
+        }
+
+        t->events.clear();
+        t->nDropped = 0;
+    }
+}
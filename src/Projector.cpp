@@ -147,6 +147,14 @@ void Projector::setProjectee(Volume src, const unsigned int nThread)
     _projectee3D.clearRL();
 }
 
+void Projector::mapProjectee(Complex* block,
+                             const int size)
+{
+    _projectee3D.mapFT(block, size, size, size);
+
+    _maxRadius = floor(size / _pf / 2 - 1);
+}
+
 /*void Projector::project(Image& dst,
                         const dmat22& mat) const
 {
@@ -334,6 +342,23 @@ void Projector::project(Image& dst,
     }
 }
 
+void Projector::project(Complex* dst,
+                        const dmat22& mat,
+                        const int* iCol,
+                        const int* iRow,
+                        const int nPxl) const
+{
+    for (int i = 0; i < nPxl; i++)
+    {
+        dvec2 newCor((double)(iCol[i] * _pf), (double)(iRow[i] * _pf));
+        dvec2 oldCor = mat * newCor;
+
+        dst[i] = _projectee2D.getByInterpolationFT(oldCor(0),
+                                                   oldCor(1),
+                                                   _interp);
+    }
+}
+
 void Projector::project(Complex* dst,
                         const dmat22& mat,
                         const int* iCol,
@@ -341,6 +366,13 @@ void Projector::project(Complex* dst,
                         const int nPxl,
                         const unsigned int nThread) const
 {
+    if (nThread == 1)
+    {
+        project(dst, mat, iCol, iRow, nPxl);
+
+        return;
+    }
+
     #pragma omp parallel for num_threads(nThread)
     for (int i = 0; i < nPxl; i++)
     {
@@ -353,6 +385,24 @@ void Projector::project(Complex* dst,
     }
 }
 
+void Projector::project(Complex* dst,
+                        const dmat33& mat,
+                        const int* iCol,
+                        const int* iRow,
+                        const int nPxl) const
+{
+    for (int i = 0; i < nPxl; i++)
+    {
+        dvec3 newCor((double)(iCol[i] * _pf), (double)(iRow[i] * _pf), 0);
+        dvec3 oldCor = mat * newCor;
+
+        dst[i] = _projectee3D.getByInterpolationFT(oldCor(0),
+                                                   oldCor(1),
+                                                   oldCor(2),
+                                                   _interp);
+    }
+}
+
 void Projector::project(Complex* dst,
                         const dmat33& mat,
                         const int* iCol,
@@ -360,6 +410,13 @@ void Projector::project(Complex* dst,
                         const int nPxl,
                         const unsigned int nThread) const
 {
+    if (nThread == 1)
+    {
+        project(dst, mat, iCol, iRow, nPxl);
+
+        return;
+    }
+
     #pragma omp parallel for num_threads(nThread)
     for (int i = 0; i < nPxl; i++)
     {
@@ -373,6 +430,258 @@ void Projector::project(Complex* dst,
     }
 }
 
+void Projector::projectBatch(Complex* dst,
+                             const dmat22* mat,
+                             const int nMat,
+                             const int* iCol,
+                             const int* iRow,
+                             const int nPxl) const
+{
+    for (int m = 0; m < nMat; m++)
+        project(dst + (size_t)m * nPxl, mat[m], iCol, iRow, nPxl);
+}
+
+void Projector::projectBatch(Complex* dst,
+                             const dmat22* mat,
+                             const int nMat,
+                             const int* iCol,
+                             const int* iRow,
+                             const int nPxl,
+                             const unsigned int nThread) const
+{
+    if (nThread == 1)
+    {
+        projectBatch(dst, mat, nMat, iCol, iRow, nPxl);
+
+        return;
+    }
+
+    for (int m = 0; m < nMat; m++)
+        project(dst + (size_t)m * nPxl, mat[m], iCol, iRow, nPxl, nThread);
+}
+
+/**
+ * interpolate a voxel of the positive half of a Fourier volume from the
+ * eight corners, x[1] and x[1] + 1 (and so as the others) are adjacent in
+ * memory, thus the corners are fetched as four pairs
+ */
+static inline Complex gatherFTHalf(const Complex* data,
+                                   const size_t index0,
+                                   const size_t box[2][2][2],
+                                   const RFLOAT w[2][2][2])
+{
+    Complex result;
+
+#if (defined(ENABLE_SIMD_256) || defined(ENABLE_SIMD_512)) && defined(SINGLE_PRECISION)
+
+    __m128 acc = _mm_setzero_ps();
+
+    for (int k = 0; k < 2; k++)
+        for (int j = 0; j < 2; j++)
+        {
+            __m128 v = _mm_loadu_ps((const float*)(data + index0 + box[k][j][0]));
+            __m128 wv = _mm_set_ps(w[k][j][1], w[k][j][1], w[k][j][0], w[k][j][0]);
+
+            acc = _mm_add_ps(acc, _mm_mul_ps(v, wv));
+        }
+
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+
+    _mm_storel_pi((__m64*)result.dat, acc);
+
+#elif (defined(ENABLE_SIMD_256) || defined(ENABLE_SIMD_512))
+
+    __m256d acc = _mm256_setzero_pd();
+
+    for (int k = 0; k < 2; k++)
+        for (int j = 0; j < 2; j++)
+        {
+            __m256d v = _mm256_loadu_pd((const double*)(data + index0 + box[k][j][0]));
+            __m256d wv = _mm256_set_pd(w[k][j][1], w[k][j][1], w[k][j][0], w[k][j][0]);
+
+            acc = _mm256_add_pd(acc, _mm256_mul_pd(v, wv));
+        }
+
+    _mm_storeu_pd(result.dat, _mm_add_pd(_mm256_castpd256_pd128(acc),
+                                         _mm256_extractf128_pd(acc, 1)));
+
+#else
+
+    result = COMPLEX(0, 0);
+
+    for (int i = 0; i < 8; i++)
+        result += data[index0 + ((const size_t*)box)[i]] * ((const RFLOAT*)w)[i];
+
+#endif
+
+    return result;
+}
+
+void Projector::projectBatch(Complex* dst,
+                             const dmat33* mat,
+                             const int nMat,
+                             const int* iCol,
+                             const int* iRow,
+                             const int nPxl) const
+{
+    if (_interp != LINEAR_INTERP)
+    {
+        for (int m = 0; m < nMat; m++)
+            project(dst + (size_t)m * nPxl, mat[m], iCol, iRow, nPxl);
+
+        return;
+    }
+
+    projectBatchRange(dst, mat, iCol, iRow, nPxl, 0, (size_t)nMat * nPxl);
+}
+
+void Projector::projectBatch(Complex* dst,
+                             const dmat33* mat,
+                             const int nMat,
+                             const int* iCol,
+                             const int* iRow,
+                             const int nPxl,
+                             const unsigned int nThread) const
+{
+    if (nThread == 1)
+    {
+        projectBatch(dst, mat, nMat, iCol, iRow, nPxl);
+
+        return;
+    }
+
+    if (_interp != LINEAR_INTERP)
+    {
+        for (int m = 0; m < nMat; m++)
+            project(dst + (size_t)m * nPxl, mat[m], iCol, iRow, nPxl, nThread);
+
+        return;
+    }
+
+    size_t nSample = (size_t)nMat * nPxl;
+
+    #pragma omp parallel num_threads(nThread)
+    {
+        // each thread takes a contiguous range of samples of the batch
+
+        size_t begin = nSample * omp_get_thread_num() / omp_get_num_threads();
+        size_t end = nSample * (omp_get_thread_num() + 1) / omp_get_num_threads();
+
+        projectBatchRange(dst, mat, iCol, iRow, nPxl, begin, end);
+    }
+}
+
+void Projector::projectBatchRange(Complex* dst,
+                                  const dmat33* mat,
+                                  const int* iCol,
+                                  const int* iRow,
+                                  const int nPxl,
+                                  const size_t begin,
+                                  const size_t end) const
+{
+    const Complex* data = _projectee3D.dataFT();
+
+    int nColFT = _projectee3D.nColFT();
+    int nRow = _projectee3D.nRowFT();
+    int nSlc = _projectee3D.nSlcFT();
+
+    size_t box[2][2][2];
+
+    FOR_CELL_DIM_3
+        box[k][j][i] = k * nColFT * nRow + j * nColFT + i;
+
+    size_t n = end - begin;
+
+    size_t* index0 = new size_t[n];
+    RFLOAT* xd = new RFLOAT[3 * n];
+    bool* conj = new bool[n];
+    int* slc = new int[n];
+    size_t* order = new size_t[n];
+
+    vector<size_t> count(nSlc + 1, 0);
+
+    // compute the core voxel and distance to it of each sample
+
+    for (size_t s = 0; s < n; s++)
+    {
+        int m = (begin + s) / nPxl;
+        int i = (begin + s) % nPxl;
+
+        dvec3 newCor((double)(iCol[i] * _pf), (double)(iRow[i] * _pf), 0);
+        dvec3 oldCor = mat[m] * newCor;
+
+        RFLOAT x[3] = {(RFLOAT)oldCor(0), (RFLOAT)oldCor(1), (RFLOAT)oldCor(2)};
+
+        conj[s] = conjHalf(x[0], x[1], x[2]);
+
+        int x0[3];
+
+        for (int d = 0; d < 3; d++)
+        {
+            x0[d] = floor(x[d]);
+            xd[3 * s + d] = x[d] - x0[d];
+        }
+
+        if ((x0[1] != -1) && (x0[2] != -1))
+        {
+            index0[s] = _projectee3D.iFTHalf(x0[0], x0[1], x0[2]);
+            slc[s] = (x0[2] >= 0) ? x0[2] : x0[2] + nSlc;
+        }
+        else
+        {
+            // the box of corners wraps around the volume, left to Volume
+            index0[s] = (size_t)-1;
+            slc[s] = 0;
+        }
+
+        count[slc[s] + 1]++;
+    }
+
+    // counting sort samples by slice of the projectee
+
+    for (int k = 0; k < nSlc; k++)
+        count[k + 1] += count[k];
+
+    for (size_t s = 0; s < n; s++)
+        order[count[slc[s]]++] = s;
+
+    // interpolate in slice order
+
+    RFLOAT w[2][2][2];
+
+    for (size_t o = 0; o < n; o++)
+    {
+        size_t s = order[o];
+
+        if (index0[s] == (size_t)-1)
+        {
+            int m = (begin + s) / nPxl;
+            int i = (begin + s) % nPxl;
+
+            dvec3 newCor((double)(iCol[i] * _pf), (double)(iRow[i] * _pf), 0);
+            dvec3 oldCor = mat[m] * newCor;
+
+            dst[begin + s] = _projectee3D.getByInterpolationFT(oldCor(0),
+                                                               oldCor(1),
+                                                               oldCor(2),
+                                                               _interp);
+            continue;
+        }
+
+        W_TRI_INTERP_LINEAR(w, xd + 3 * s);
+
+        Complex result = gatherFTHalf(data, index0[s], box, w);
+
+        dst[begin + s] = conj[s] ? CONJUGATE(result) : result;
+    }
+
+    delete[] index0;
+    delete[] xd;
+    delete[] conj;
+    delete[] slc;
+    delete[] order;
+}
+
 //void Projector::project(Image& dst,
 //                        const dmat22& rot,
 //                        const dvec2& t) const
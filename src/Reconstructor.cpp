@@ -131,6 +131,22 @@ void Reconstructor::allocSpace(const unsigned int nThread)
         _C3D.alloc(PAD_SIZE, PAD_SIZE, PAD_SIZE, FT_SPACE);
         _T3D.alloc(PAD_SIZE, PAD_SIZE, PAD_SIZE, FT_SPACE);
 
+#ifdef RECONSTRUCTOR_ALLREDUCE_SHELL
+        _shellRadius = -1;
+#endif
+
+#ifdef RECONSTRUCTOR_INSERT_SLAB
+        _nInsertSlab = omp_get_max_threads() * RECONSTRUCTOR_INSERT_SLAB_PER_THREAD;
+
+        _insertBin.clear();
+        _insertBin.resize(omp_get_max_threads() * _nInsertSlab);
+#endif
+
+#ifdef RECONSTRUCTOR_INSERT_PRIVATE
+        _insertF.assign(omp_get_max_threads(), (Complex*)NULL);
+        _insertT.assign(omp_get_max_threads(), (RFLOAT*)NULL);
+        _insertExtent.assign(omp_get_max_threads(), 0);
+#endif
     }
     else 
     {
@@ -172,6 +188,21 @@ void Reconstructor::freeSpace()
         _C3D.clear();
         _T3D.clear();
 
+#ifdef RECONSTRUCTOR_INSERT_SLAB
+        vector<vector<InsertRecord> >().swap(_insertBin);
+#endif
+
+#ifdef RECONSTRUCTOR_INSERT_PRIVATE
+        for (size_t t = 0; t < _insertF.size(); t++)
+        {
+            free(_insertF[t]);
+            free(_insertT[t]);
+        }
+
+        _insertF.clear();
+        _insertT.clear();
+        _insertExtent.clear();
+#endif
     }
     else 
     {
@@ -802,6 +833,16 @@ void Reconstructor::insertP(const Complex* src,
     NAN_CHECK_DMAT33(rot);
     POINT_NAN_CHECK(w);
 
+#endif
+
+#ifdef RECONSTRUCTOR_INSERT_BUFFERED
+    int thread = omp_get_thread_num();
+
+#ifdef RECONSTRUCTOR_INSERT_SLAB
+    bool buffered = ((size_t)(thread + 1) * _nInsertSlab <= _insertBin.size());
+#else
+    bool buffered = ((size_t)thread < _insertF.size());
+#endif
 #endif
 
     for (int i = 0; i < _nPxl; i++)
@@ -814,6 +855,25 @@ void Reconstructor::insertP(const Complex* src,
         oldCor[1] = ptr[1] * iCol + ptr[4] * iRow;
         oldCor[2] = ptr[2] * iCol + ptr[5] * iRow;
 
+#ifdef RECONSTRUCTOR_INSERT_BUFFERED
+        if (buffered)
+        {
+            insertBuffered(thread,
+                           src[i]
+                         * ctf[i]
+                         * (sig == NULL ? 1 : (*sig)(_iSig[i]))
+                         * w,
+                           TSGSL_pow_2(ctf[i])
+                         * (sig == NULL ? 1 : (*sig)(_iSig[i]))
+                         * w,
+                           (RFLOAT)oldCor[0],
+                           (RFLOAT)oldCor[1],
+                           (RFLOAT)oldCor[2]);
+
+            continue;
+        }
+#endif
+
 #ifdef RECONSTRUCTOR_MKB_KERNEL
         _F3D.addFT(src[i]
                  * ctf[i]
@@ -862,6 +922,511 @@ void Reconstructor::insertP(const Complex* src,
     }
 }
 
+#ifdef RECONSTRUCTOR_INSERT_BUFFERED
+
+void Reconstructor::flushInsertP()
+{
+    if (_mode != MODE_3D) return;
+
+#ifdef RECONSTRUCTOR_INSERT_SLAB
+
+    int nThread = _insertBin.size() / _nInsertSlab;
+
+    Complex* F = &_F3D[0];
+    Complex* T = &_T3D[0];
+
+    // each z-slab is owned by one thread, so no two threads update the same voxel
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int s = 0; s < _nInsertSlab; s++)
+    {
+        for (int t = 0; t < nThread; t++)
+        {
+            vector<InsertRecord>& bin = _insertBin[t * _nInsertSlab + s];
+
+            for (size_t r = 0; r < bin.size(); r++)
+            {
+                const InsertRecord& rec = bin[r];
+
+                for (int k = 0; k < 2; k++)
+                {
+                    if (!(rec.plane & (1 << k))) continue;
+
+                    for (int j = 0; j < 2; j++)
+                        for (int i = 0; i < 2; i++)
+                        {
+                            size_t index = rec.index + _F3D._box[k][j][i];
+
+                            F[index].dat[0] += rec.f.dat[0] * rec.w[k][j][i];
+                            F[index].dat[1] += rec.f.dat[1] * rec.w[k][j][i];
+
+                            T[index].dat[0] += rec.t * rec.w[k][j][i];
+                        }
+                }
+            }
+
+            // release the capacity, or the peak of the records would be held for good
+
+            vector<InsertRecord>().swap(bin);
+        }
+    }
+
+#endif
+
+#ifdef RECONSTRUCTOR_INSERT_PRIVATE
+
+    int nThread = _insertF.size();
+
+    int extent = 0;
+
+    for (int t = 0; t < nThread; t++)
+        extent = GSL_MAX_INT(extent, _insertExtent[t]);
+
+    // only the box touched by insertion is reduced
+
+    int kMin = GSL_MAX_INT(-extent, -_F3D.nSlcFT() / 2);
+    int kMax = GSL_MIN_INT(extent, _F3D.nSlcFT() / 2 - 1);
+    int jMin = GSL_MAX_INT(-extent, -_F3D.nRowFT() / 2);
+    int jMax = GSL_MIN_INT(extent, _F3D.nRowFT() / 2 - 1);
+    int iMax = GSL_MIN_INT(extent, _F3D.nColFT() - 1);
+
+    Complex* F = &_F3D[0];
+    Complex* T = &_T3D[0];
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int k = kMin; k <= kMax; k++)
+        for (int j = jMin; j <= jMax; j++)
+        {
+            size_t index0 = (size_t)(k >= 0 ? k : k + _F3D.nSlcFT()) * _F3D.nColFT() * _F3D.nRowFT()
+                          + (size_t)(j >= 0 ? j : j + _F3D.nRowFT()) * _F3D.nColFT();
+
+            for (int t = 0; t < nThread; t++)
+            {
+                if (_insertF[t] == NULL) continue;
+
+                for (int i = 0; i <= iMax; i++)
+                {
+                    F[index0 + i].dat[0] += _insertF[t][index0 + i].dat[0];
+                    F[index0 + i].dat[1] += _insertF[t][index0 + i].dat[1];
+
+                    T[index0 + i].dat[0] += _insertT[t][index0 + i];
+                }
+            }
+        }
+
+    for (int t = 0; t < nThread; t++)
+    {
+        free(_insertF[t]);
+        free(_insertT[t]);
+
+        _insertF[t] = NULL;
+        _insertT[t] = NULL;
+
+        _insertExtent[t] = 0;
+    }
+
+#endif
+}
+
+void Reconstructor::insertBuffered(const int thread,
+                                   Complex f,
+                                   const RFLOAT t,
+                                   RFLOAT iCol,
+                                   RFLOAT iRow,
+                                   RFLOAT iSlc)
+{
+    if (conjHalf(iCol, iRow, iSlc)) f = CONJUGATE(f);
+
+    RFLOAT w[2][2][2];
+    int x0[3];
+    RFLOAT x[3] = {iCol, iRow, iSlc};
+
+    WG_TRI_INTERP_LINEAR(w, x0, x);
+
+    if ((x0[1] == -1) ||
+        (x0[2] == -1))
+    {
+        // the box wraps around the boundary of the volume, which is rare, add it atomically
+
+        for (int k = 0; k < 2; k++)
+            for (int j = 0; j < 2; j++)
+                for (int i = 0; i < 2; i++)
+                {
+                    _F3D.addFTHalf(f * w[k][j][i], x0[0] + i, x0[1] + j, x0[2] + k);
+                    _T3D.addFTHalf(t * w[k][j][i], x0[0] + i, x0[1] + j, x0[2] + k);
+                }
+
+        return;
+    }
+
+    size_t index0 = (size_t)(x0[2] >= 0 ? x0[2] : x0[2] + _F3D._nSlc) * _F3D._nColFT * _F3D._nRow
+                  + (size_t)(x0[1] >= 0 ? x0[1] : x0[1] + _F3D._nRow) * _F3D._nColFT
+                  + x0[0];
+
+#ifdef RECONSTRUCTOR_INSERT_SLAB
+
+    // the active region [-r, r] along z is divided evenly into slabs
+
+    int r = GSL_MIN_INT(_maxRadius * _pf + 1, _F3D._nSlc / 2);
+
+    int s0 = GSL_MAX_INT(0, GSL_MIN_INT(_nInsertSlab - 1, (x0[2] + r) * _nInsertSlab / (2 * r + 1)));
+    int s1 = GSL_MAX_INT(0, GSL_MIN_INT(_nInsertSlab - 1, (x0[2] + 1 + r) * _nInsertSlab / (2 * r + 1)));
+
+    InsertRecord rec;
+
+    rec.index = index0;
+    memcpy(rec.w, w, sizeof(rec.w));
+    rec.f = f;
+    rec.t = t;
+
+    if (s0 == s1)
+    {
+        rec.plane = 3;
+        _insertBin[thread * _nInsertSlab + s0].push_back(rec);
+    }
+    else
+    {
+        rec.plane = 1;
+        _insertBin[thread * _nInsertSlab + s0].push_back(rec);
+
+        rec.plane = 2;
+        _insertBin[thread * _nInsertSlab + s1].push_back(rec);
+    }
+
+#endif
+
+#ifdef RECONSTRUCTOR_INSERT_PRIVATE
+
+    if (_insertF[thread] == NULL)
+    {
+        // pages outside the touched region are never written, hence never committed
+
+        _insertF[thread] = (Complex*)calloc(_F3D.sizeFT(), sizeof(Complex));
+        _insertT[thread] = (RFLOAT*)calloc(_F3D.sizeFT(), sizeof(RFLOAT));
+
+        if ((_insertF[thread] == NULL) || (_insertT[thread] == NULL))
+        {
+            REPORT_ERROR("FAIL TO ALLOCATE SPACE FOR PRIVATE INSERTION");
+
+            abort();
+        }
+    }
+
+    Complex* F = _insertF[thread];
+    RFLOAT* T = _insertT[thread];
+
+    for (int k = 0; k < 2; k++)
+        for (int j = 0; j < 2; j++)
+            for (int i = 0; i < 2; i++)
+            {
+                size_t index = index0 + _F3D._box[k][j][i];
+
+                F[index].dat[0] += f.dat[0] * w[k][j][i];
+                F[index].dat[1] += f.dat[1] * w[k][j][i];
+
+                T[index] += t * w[k][j][i];
+            }
+
+    int extent = GSL_MAX_INT(x0[0] + 1,
+                             GSL_MAX_INT(GSL_MAX_INT(abs(x0[1]), abs(x0[1] + 1)),
+                                         GSL_MAX_INT(abs(x0[2]), abs(x0[2] + 1))));
+
+    if (extent > _insertExtent[thread]) _insertExtent[thread] = extent;
+
+#endif
+}
+
+#endif
+
+#ifndef GPU_INSERT
+
+/**
+ * rotate the coordinates (col, row, 0) of n pixels by a matrix, the results
+ * are stored in x, y and z
+ */
+static void rotatePixel(RFLOAT* x,
+                        RFLOAT* y,
+                        RFLOAT* z,
+                        const RFLOAT* col,
+                        const RFLOAT* row,
+                        const int n,
+                        const dmat33& rot)
+{
+    const double* ptr = rot.data();
+
+    int i = 0;
+
+#if (defined(ENABLE_SIMD_256) || defined(ENABLE_SIMD_512)) && defined(SINGLE_PRECISION)
+
+    __m256 r0 = _mm256_set1_ps((float)ptr[0]);
+    __m256 r1 = _mm256_set1_ps((float)ptr[1]);
+    __m256 r2 = _mm256_set1_ps((float)ptr[2]);
+    __m256 r3 = _mm256_set1_ps((float)ptr[3]);
+    __m256 r4 = _mm256_set1_ps((float)ptr[4]);
+    __m256 r5 = _mm256_set1_ps((float)ptr[5]);
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 c = _mm256_loadu_ps(col + i);
+        __m256 r = _mm256_loadu_ps(row + i);
+
+        _mm256_storeu_ps(x + i, _mm256_add_ps(_mm256_mul_ps(r0, c), _mm256_mul_ps(r3, r)));
+        _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_mul_ps(r1, c), _mm256_mul_ps(r4, r)));
+        _mm256_storeu_ps(z + i, _mm256_add_ps(_mm256_mul_ps(r2, c), _mm256_mul_ps(r5, r)));
+    }
+
+#elif (defined(ENABLE_SIMD_256) || defined(ENABLE_SIMD_512))
+
+    __m256d r0 = _mm256_set1_pd(ptr[0]);
+    __m256d r1 = _mm256_set1_pd(ptr[1]);
+    __m256d r2 = _mm256_set1_pd(ptr[2]);
+    __m256d r3 = _mm256_set1_pd(ptr[3]);
+    __m256d r4 = _mm256_set1_pd(ptr[4]);
+    __m256d r5 = _mm256_set1_pd(ptr[5]);
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256d c = _mm256_loadu_pd(col + i);
+        __m256d r = _mm256_loadu_pd(row + i);
+
+        _mm256_storeu_pd(x + i, _mm256_add_pd(_mm256_mul_pd(r0, c), _mm256_mul_pd(r3, r)));
+        _mm256_storeu_pd(y + i, _mm256_add_pd(_mm256_mul_pd(r1, c), _mm256_mul_pd(r4, r)));
+        _mm256_storeu_pd(z + i, _mm256_add_pd(_mm256_mul_pd(r2, c), _mm256_mul_pd(r5, r)));
+    }
+
+#endif
+
+    for (; i < n; i++)
+    {
+        x[i] = ptr[0] * col[i] + ptr[3] * row[i];
+        y[i] = ptr[1] * col[i] + ptr[4] * row[i];
+        z[i] = ptr[2] * col[i] + ptr[5] * row[i];
+    }
+}
+
+void Reconstructor::insertI(Complex* datP,
+                            RFLOAT* ctfP,
+                            int* ctfIdx,
+                            RFLOAT* sigP,
+                            int* sigIdx,
+                            RFLOAT* w,
+                            double* offS,
+                            double* nr,
+                            double* nt,
+                            double* nd,
+                            CTFAttr* ctfaData,
+                            RFLOAT pixelSize,
+                            bool cSearch,
+                            int opf,
+                            int mReco,
+                            int idim,
+                            int imgNum)
+{
+    PROFILE_SCOPE("insertI");
+
+#ifdef RECONSTRUCTOR_ASSERT_CHECK
+    IF_MASTER
+        REPORT_ERROR("INSERTING IMAGES INTO RECONSTRUCTOR IN MASTER");
+
+    if (_calMode != PRE_CAL_MODE)
+        REPORT_ERROR("WRONG PRE(POST) CALCULATION MODE IN RECONSTRUCTOR");
+#endif
+
+    if (_mode != MODE_3D)
+    {
+        REPORT_ERROR("BATCHED INSERTION IS ONLY SUPPORTED IN 3D MODE");
+
+        abort();
+    }
+
+    // coordinates of pixels before rotation and their indices in the phase ramps
+
+    RFLOAT* col = (RFLOAT*)TSFFTW_malloc(_nPxl * sizeof(RFLOAT));
+    RFLOAT* row = (RFLOAT*)TSFFTW_malloc(_nPxl * sizeof(RFLOAT));
+
+    int* iColRamp = new int[_nPxl];
+    int* iRowRamp = new int[_nPxl];
+
+    for (int i = 0; i < _nPxl; i++)
+    {
+        col[i] = _iCol[i];
+        row[i] = _iRow[i];
+
+        iColRamp[i] = _iCol[i] / opf;
+        iRowRamp[i] = _iRow[i] / opf + idim / 2;
+    }
+
+    int nColRamp = idim / 2 + 1;
+    int nRowRamp = idim + 1;
+
+    ptrdiff_t nSample = (ptrdiff_t)imgNum * mReco;
+
+#ifdef RECONSTRUCTOR_INSERT_SLAB
+    ptrdiff_t nBlock = RECONSTRUCTOR_INSERT_I_BLOCK;
+#else
+    ptrdiff_t nBlock = nSample;
+#endif
+
+    for (ptrdiff_t b = 0; b < nSample; b += nBlock)
+    {
+        ptrdiff_t e = GSL_MIN(b + nBlock, nSample);
+
+        #pragma omp parallel
+        {
+            RFLOAT* x = (RFLOAT*)TSFFTW_malloc(_nPxl * sizeof(RFLOAT));
+            RFLOAT* y = (RFLOAT*)TSFFTW_malloc(_nPxl * sizeof(RFLOAT));
+            RFLOAT* z = (RFLOAT*)TSFFTW_malloc(_nPxl * sizeof(RFLOAT));
+
+            RFLOAT* ctfBuf = cSearch ? (RFLOAT*)TSFFTW_malloc(_nPxl * sizeof(RFLOAT)) : NULL;
+
+            Complex* colRamp = new Complex[nColRamp];
+            Complex* rowRamp = new Complex[nRowRamp];
+
+#ifdef RECONSTRUCTOR_INSERT_BUFFERED
+            int thread = omp_get_thread_num();
+
+#ifdef RECONSTRUCTOR_INSERT_SLAB
+            bool buffered = ((size_t)(thread + 1) * _nInsertSlab <= _insertBin.size());
+#else
+            bool buffered = ((size_t)thread < _insertF.size());
+#endif
+#endif
+
+            #pragma omp for schedule(dynamic)
+            for (ptrdiff_t s = b; s < e; s++)
+            {
+                int l = s / mReco;
+
+                dmat33 rot;
+
+                rotate3D(rot, dvec4(nr[s * 4], nr[s * 4 + 1], nr[s * 4 + 2], nr[s * 4 + 3]));
+
+#ifdef OPTIMISER_RECENTRE_IMAGE_EACH_ITERATION
+                dvec2 tran(nt[s * 2] - offS[l * 2], nt[s * 2 + 1] - offS[l * 2 + 1]);
+#else
+                dvec2 tran(nt[s * 2], nt[s * 2 + 1]);
+#endif
+
+                // the phase of translation is separable, exp(2 * pi * i * (c * tx + r * ty) / idim) = exp(2 * pi * i * c * tx / idim) * exp(2 * pi * i * r * ty / idim)
+
+                for (int c = 0; c < nColRamp; c++)
+                    colRamp[c] = COMPLEX_POLAR(M_2X_PI * c * tran(0) / idim);
+
+                for (int r = 0; r < nRowRamp; r++)
+                    rowRamp[r] = COMPLEX_POLAR(M_2X_PI * (r - idim / 2) * tran(1) / idim);
+
+                const RFLOAT* ctf;
+
+                if (cSearch)
+                {
+                    CTF(ctfBuf,
+                        pixelSize,
+                        ctfaData[l].voltage,
+                        ctfaData[l].defocusU * nd[s],
+                        ctfaData[l].defocusV * nd[s],
+                        ctfaData[l].defocusTheta,
+                        ctfaData[l].Cs,
+                        ctfaData[l].amplitudeContrast,
+                        ctfaData[l].phaseShift,
+                        idim * opf,
+                        idim * opf,
+                        _iCol,
+                        _iRow,
+                        _nPxl);
+
+                    ctf = ctfBuf;
+                }
+                else
+                {
+                    ctf = ctfP + (size_t)_nPxl * (ctfIdx ? ctfIdx[l] : l);
+                }
+
+                const Complex* src = datP + (size_t)_nPxl * l;
+
+#ifdef OPTIMISER_RECONSTRUCT_SIGMA_REGULARISE
+                const RFLOAT* sig = sigP + (size_t)_nPxl * (sigIdx ? sigIdx[l] : l);
+#endif
+
+#ifndef NAN_NO_CHECK
+                SEGMENT_NAN_CHECK_COMPLEX(src, (size_t)_nPxl);
+                SEGMENT_NAN_CHECK(ctf, (size_t)_nPxl);
+                NAN_CHECK_DMAT33(rot);
+                POINT_NAN_CHECK(w[l]);
+#endif
+
+                rotatePixel(x, y, z, col, row, _nPxl, rot);
+
+                for (int i = 0; i < _nPxl; i++)
+                {
+#ifdef OPTIMISER_RECONSTRUCT_SIGMA_REGULARISE
+                    RFLOAT t = ctf[i] * sig[i] * w[l];
+#else
+                    RFLOAT t = ctf[i] * w[l];
+#endif
+
+                    Complex f = src[i] * colRamp[iColRamp[i]] * rowRamp[iRowRamp[i]] * t;
+
+                    t *= ctf[i];
+
+#ifdef RECONSTRUCTOR_INSERT_BUFFERED
+                    if (buffered)
+                    {
+                        insertBuffered(thread, f, t, x[i], y[i], z[i]);
+
+                        continue;
+                    }
+#endif
+
+#ifdef RECONSTRUCTOR_MKB_KERNEL
+                    _F3D.addFT(f, x[i], y[i], z[i], _pf * _a, _kernelFT);
+#endif
+
+#ifdef RECONSTRUCTOR_TRILINEAR_KERNEL
+                    _F3D.addFT(f, x[i], y[i], z[i]);
+#endif
+
+#ifdef RECONSTRUCTOR_ADD_T_DURING_INSERT
+
+#ifdef RECONSTRUCTOR_MKB_KERNEL
+                    _T3D.addFT(t, x[i], y[i], z[i], _pf * _a, _kernelFT);
+#endif
+
+#ifdef RECONSTRUCTOR_TRILINEAR_KERNEL
+                    _T3D.addFT(t, x[i], y[i], z[i]);
+#endif
+
+#endif
+                }
+
+                dvec3 dir = -rot * dvec3(tran(0), tran(1), 0);
+
+                insertDir(dir);
+            }
+
+            TSFFTW_free(x);
+            TSFFTW_free(y);
+            TSFFTW_free(z);
+
+            if (cSearch) TSFFTW_free(ctfBuf);
+
+            delete[] colRamp;
+            delete[] rowRamp;
+        }
+
+#ifdef RECONSTRUCTOR_INSERT_BUFFERED
+        flushInsertP();
+#endif
+    }
+
+    TSFFTW_free(col);
+    TSFFTW_free(row);
+
+    delete[] iColRamp;
+    delete[] iRowRamp;
+}
+
+#endif
+
 #ifdef GPU_INSERT
 
 void Reconstructor::insertI(Complex* datP,
@@ -881,6 +1446,8 @@ void Reconstructor::insertI(Complex* datP,
                             int idim,
                             int imgNum)
 {   
+    PROFILE_SCOPE("insertI");
+
     double* O3D = new double[3];
     int* counter = new int[1];
     O3D[0] = _ox;
@@ -941,6 +1508,8 @@ void Reconstructor::insertI(Complex* datP,
                             int idim,
                             int imgNum)
 {   
+    PROFILE_SCOPE("insertI");
+
     double* O3D = new double[3];
     int* counter = new int[1];
     O3D[0] = _ox;
@@ -1093,6 +1662,8 @@ void Reconstructor::prepareTF(const unsigned int nThread)
 void Reconstructor::reconstruct(Image& dst,
                                 const unsigned int nThread)
 {
+    PROFILE_SCOPE("reconstruct");
+
     Volume tmp;
 
     reconstruct(tmp, nThread);
@@ -1131,6 +1702,8 @@ void Reconstructor::reconstruct(Volume& dst,
 {
     IF_MASTER return;
 
+    PROFILE_SCOPE("reconstruct");
+
 #ifdef VERBOSE_LEVEL_2
 
     IF_MODE_2D
@@ -2349,6 +2922,7 @@ void Reconstructor::reconstructG(Volume& dst,
 
 void Reconstructor::allReduceF()
 {
+    PROFILE_SCOPE("allReduceF");
 
     ALOG(INFO, "LOGGER_RECO") << "Waiting for Synchronizing all Processes in Hemisphere A";
     BLOG(INFO, "LOGGER_RECO") << "Waiting for Synchronizing all Processes in Hemisphere B";
@@ -2380,11 +2954,35 @@ void Reconstructor::allReduceF()
         SEGMENT_NAN_CHECK_COMPLEX(&_F3D[0], _F3D.sizeFT());
 #endif
 
+#ifdef RECONSTRUCTOR_ALLREDUCE_SHELL
+        buildShell();
+
+        size_t nShell = _shellIndex.size();
+
+        Complex* buf = (Complex*)TSFFTW_malloc(nShell * sizeof(Complex));
+
+        #pragma omp parallel for
+        for (size_t s = 0; s < nShell; s++)
+            buf[s] = _F3D[_shellIndex[s]];
+
+        MPI_Allreduce_Large(buf,
+                            nShell,
+                            TS_MPI_DOUBLE_COMPLEX,
+                            MPI_SUM,
+                            _hemi);
+
+        #pragma omp parallel for
+        for (size_t s = 0; s < nShell; s++)
+            _F3D[_shellIndex[s]] = buf[s];
+
+        TSFFTW_free(buf);
+#else
         MPI_Allreduce_Large(&_F3D[0],
                             _F3D.sizeFT(),
                             TS_MPI_DOUBLE_COMPLEX,
                             MPI_SUM,
                             _hemi);
+#endif
 
 #ifndef NAN_NO_CHECK
         SEGMENT_NAN_CHECK_COMPLEX(&_F3D[0], _F3D.sizeFT());
@@ -2402,6 +3000,8 @@ void Reconstructor::allReduceF()
 
 void Reconstructor::allReduceT(const unsigned int nThread)
 {
+    PROFILE_SCOPE("allReduceT");
+
     ALOG(INFO, "LOGGER_RECO") << "Waiting for Synchronizing all Processes in Hemisphere A";
     BLOG(INFO, "LOGGER_RECO") << "Waiting for Synchronizing all Processes in Hemisphere B";
 
@@ -2433,11 +3033,37 @@ void Reconstructor::allReduceT(const unsigned int nThread)
         SEGMENT_NAN_CHECK_COMPLEX(&_T3D[0], _T3D.sizeFT());
 #endif
 
+#ifdef RECONSTRUCTOR_ALLREDUCE_SHELL
+        buildShell();
+
+        size_t nShell = _shellIndex.size();
+
+        // T is real, only the real part is reduced
+
+        RFLOAT* buf = (RFLOAT*)TSFFTW_malloc(nShell * sizeof(RFLOAT));
+
+        #pragma omp parallel for num_threads(nThread)
+        for (size_t s = 0; s < nShell; s++)
+            buf[s] = REAL(_T3D[_shellIndex[s]]);
+
+        MPI_Allreduce_Large(buf,
+                            nShell,
+                            TS_MPI_DOUBLE,
+                            MPI_SUM,
+                            _hemi);
+
+        #pragma omp parallel for num_threads(nThread)
+        for (size_t s = 0; s < nShell; s++)
+            _T3D[_shellIndex[s]] = COMPLEX(buf[s], 0);
+
+        TSFFTW_free(buf);
+#else
         MPI_Allreduce_Large(&_T3D[0],
                             _T3D.sizeFT(),
                             TS_MPI_DOUBLE_COMPLEX,
                             MPI_SUM,
                             _hemi);
+#endif
 
 #ifndef NAN_NO_CHECK
         SEGMENT_NAN_CHECK_COMPLEX(&_T2D[0], _T3D.sizeFT());
@@ -2483,6 +3109,48 @@ void Reconstructor::allReduceT(const unsigned int nThread)
 #endif
 }
 
+#ifdef RECONSTRUCTOR_ALLREDUCE_SHELL
+
+void Reconstructor::buildShell()
+{
+#ifdef RECONSTRUCTOR_MKB_KERNEL
+    // a modified Kaiser-Bessel blob reaches at most _pf * _a voxels away from the inserted point
+
+    int r = _maxRadius * _pf + (int)ceil(_pf * _a) + 1;
+#else
+    // a trilinear box reaches at most sqrt(3) voxels away from the inserted point
+
+    int r = _maxRadius * _pf + 2;
+#endif
+
+    if (r == _shellRadius) return;
+
+    _shellRadius = r;
+
+    _shellIndex.clear();
+
+    for (int k = GSL_MAX_INT(-r, -_F3D.nSlcFT() / 2); k < GSL_MIN_INT(r + 1, _F3D.nSlcFT() / 2); k++)
+        for (int j = GSL_MAX_INT(-r, -_F3D.nRowFT() / 2); j < GSL_MIN_INT(r + 1, _F3D.nRowFT() / 2); j++)
+            for (int i = 0; i <= GSL_MIN_INT(r, _F3D.nColFT() - 1); i++)
+                if (QUAD_3(i, j, k) < TSGSL_pow_2(r))
+                    _shellIndex.push_back(_F3D.iFTHalf(i, j, k));
+
+    std::sort(_shellIndex.begin(), _shellIndex.end());
+
+    ALOG(INFO, "LOGGER_RECO") << "Active Shell of Reconstructor Holds "
+                              << _shellIndex.size()
+                              << " out of "
+                              << _F3D.sizeFT()
+                              << " Voxels";
+    BLOG(INFO, "LOGGER_RECO") << "Active Shell of Reconstructor Holds "
+                              << _shellIndex.size()
+                              << " out of "
+                              << _F3D.sizeFT()
+                              << " Voxels";
+}
+
+#endif
+
 void Reconstructor::allReduceO()
 {
     ALOG(INFO, "LOGGER_RECO") << "Waiting for Synchronizing all Processes in Hemisphere A";